@@ -0,0 +1,103 @@
+#include <cstdlib>
+#include <new>
+
+#include "AsyncFlusher.h"
+
+AsyncFlusher::AsyncFlusher(BinaryIOStream* stream, int bufferCount, int bufferSize, int bufferAlignment) :
+		fullBlocks(bufferCount + 1), freeBuffers(bufferCount + 1), submitted(0), completed(0), error(None), stopping(false) {
+	this->stream = stream;
+
+	for (int i = 0; i < bufferCount; i++) {
+		void* memory = NULL;
+		if (bufferAlignment > 0) {
+			if (posix_memalign(&memory, bufferAlignment, bufferSize) != 0) {
+				memory = NULL;
+			}
+		} else {
+			memory = malloc(bufferSize);
+		}
+		if (memory == NULL) {
+			char* buffer;
+			while (freeBuffers.pop(buffer)) {
+				free(buffer);
+			}
+			throw std::bad_alloc();
+		}
+		freeBuffers.push((char*)memory);
+	}
+
+	thread = std::thread(&AsyncFlusher::run, this);
+}
+
+AsyncFlusher::~AsyncFlusher() {
+	drain();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		flusherWake.notify_one();
+	}
+	thread.join();
+
+	// buffers were swapped with the writer's, so whatever is left in the
+	// free queue is ours to release regardless of who allocated it
+	char* buffer;
+	while (freeBuffers.pop(buffer)) {
+		free(buffer);
+	}
+}
+
+char* AsyncFlusher::submit(char* buffer, int size) {
+	if (size <= 0) {
+		return buffer;
+	}
+
+	submitted++;
+	fullBlocks.push(Block { buffer, size });
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		flusherWake.notify_one();
+	}
+
+	char* next;
+	while (!freeBuffers.pop(next)) {
+		// backpressure; every buffer is in flight
+		std::unique_lock<std::mutex> lock(mutex);
+		producerWake.wait(lock, [this] { return !freeBuffers.empty(); });
+	}
+
+	return next;
+}
+
+void AsyncFlusher::drain() {
+	std::unique_lock<std::mutex> lock(mutex);
+	producerWake.wait(lock, [this] { return (completed.load() == submitted.load()); });
+}
+
+BinaryIOError AsyncFlusher::getError() {
+	return (BinaryIOError)error.load();
+}
+
+void AsyncFlusher::run() {
+	while (true) {
+		Block block;
+		if (fullBlocks.pop(block)) {
+			// after a failure keep cycling buffers so the producer never
+			// stalls, but stop touching the file
+			if ((error.load() == None) && (stream->write(block.data, block.size) < 0)) {
+				error = GenericWriteError;
+			}
+			freeBuffers.push(block.data);
+			completed++;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			producerWake.notify_all();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		if (stopping) {
+			break;
+		}
+		flusherWake.wait(lock, [this] { return (!fullBlocks.empty() || stopping.load()); });
+	}
+}
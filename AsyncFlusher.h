@@ -0,0 +1,99 @@
+#ifndef __ASYNCFLUSHER_H__
+#define __ASYNCFLUSHER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BinaryIOStream.h"
+
+// Single producer, single consumer ring. push() and pop() never block and
+// never take a lock; each side only writes its own index.
+template <typename T>
+class SpscQueue {
+	public:
+		SpscQueue(size_t capacity);
+		bool push(const T& value);
+		bool pop(T& value);
+		bool empty();
+
+	private:
+		vector<T> slots;
+		size_t mask;
+		std::atomic<size_t> head, tail;
+};
+
+// Background writer for BinaryWriter. Full buffers are queued to a flusher
+// thread and the producer gets an empty one back straight away. At most
+// bufferCount buffers are in flight; when all of them are, submit() blocks
+// until the flusher hands one back.
+class AsyncFlusher {
+	public:
+		AsyncFlusher(BinaryIOStream* stream, int bufferCount, int bufferSize, int bufferAlignment);
+		~AsyncFlusher();
+		// owns the rotating buffers and the flusher thread
+		AsyncFlusher(const AsyncFlusher&) = delete;
+		AsyncFlusher& operator=(const AsyncFlusher&) = delete;
+		char* submit(char* buffer, int size);
+		void drain();
+		BinaryIOError getError();
+
+	private:
+		struct Block {
+			char* data;
+			int size;
+		};
+		void run();
+		BinaryIOStream* stream;
+		SpscQueue<Block> fullBlocks;
+		SpscQueue<char*> freeBuffers;
+		std::atomic<uint64_t> submitted, completed;
+		std::atomic<int> error;
+		std::atomic<bool> stopping;
+		std::mutex mutex;
+		std::condition_variable flusherWake, producerWake;
+		std::thread thread;
+};
+
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity) : head(0), tail(0) {
+	size_t size = 2;
+	while (size < capacity) {
+		size *= 2;
+	}
+	slots.resize(size);
+	mask = size - 1;
+}
+
+template <typename T>
+bool SpscQueue<T>::push(const T& value) {
+	size_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) > mask) {
+		return false;
+	}
+
+	slots[t & mask] = value;
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T& value) {
+	size_t h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	value = slots[h & mask];
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::empty() {
+	return (head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire));
+}
+
+#endif // __ASYNCFLUSHER_H__
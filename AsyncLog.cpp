@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "AsyncLog.h"
+
+AsyncLog::AsyncLog(int capacity, int flushInterval, LogOverflowPolicy policy) :
+		head(0), tail(0), written(0), drainTarget(0), dropped(0), stopping(false), idle(false), flushInterval(std::max(flushInterval, 1)) {
+	size_t size = 2;
+	while (size < (size_t)capacity) {
+		size *= 2;
+	}
+	records.reset(new Record[size]);
+	for (size_t i = 0; i < size; i++) {
+		records[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	mask = size - 1;
+	this->policy = policy;
+
+	thread = std::thread(&AsyncLog::run, this);
+}
+
+AsyncLog::~AsyncLog() {
+	drain();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		drainWake.notify_one();
+	}
+	thread.join();
+}
+
+void AsyncLog::append(FILE* target, const char* fmt, va_list args) {
+	size_t position;
+	while (!claim(position)) {
+		if (policy == DropOnOverflow) {
+			wakeDrain();
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		// every slot is taken; get the drain thread going and wait for room
+		std::unique_lock<std::mutex> lock(mutex);
+		drainWake.notify_one();
+		producerWake.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	// format in place; the drain thread stops at this slot until it is
+	// published, so nothing else touches it meanwhile
+	Record& record = records[position & mask];
+	record.target = target;
+	record.longText = NULL;
+	va_list retry;
+	va_copy(retry, args);
+	int length = vsnprintf(record.text, RECORD_SIZE, fmt, args);
+	if (length >= RECORD_SIZE) {
+		record.longText = (char*)malloc(length + 1);
+		if (record.longText != NULL) {
+			vsnprintf(record.longText, length + 1, fmt, retry);
+		} else {
+			length = RECORD_SIZE - 1;
+		}
+	}
+	va_end(retry);
+	record.length = std::max(length, 0);
+	record.sequence.store(position + 1, std::memory_order_release);
+
+	// get a sleeping drain thread going once the ring is half full rather
+	// than waiting out the flush interval; head is current while it sleeps
+	if (idle.load(std::memory_order_acquire) && (position - head.load(std::memory_order_acquire) >= mask / 2)) {
+		wakeDrain();
+	}
+}
+
+// Only the producer that clears idle notifies, so a full ring does not turn
+// into a stream of wakeups. A producer that finds idle still clear has
+// nothing to do: the drain thread checks the fill level under the mutex
+// after setting it.
+void AsyncLog::wakeDrain() {
+	if (idle.exchange(false)) {
+		std::lock_guard<std::mutex> lock(mutex);
+		drainWake.notify_one();
+	}
+}
+
+void AsyncLog::drain() {
+	size_t target = tail.load(std::memory_order_acquire);
+	std::unique_lock<std::mutex> lock(mutex);
+	if (drainTarget.load() < target) {
+		drainTarget = target;
+	}
+	drainWake.notify_one();
+	producerWake.wait(lock, [this, target] { return (written.load() >= target); });
+}
+
+uint64_t AsyncLog::getDropped() {
+	return dropped.load(std::memory_order_relaxed);
+}
+
+bool AsyncLog::claim(size_t& position) {
+	position = tail.load(std::memory_order_relaxed);
+	while (true) {
+		size_t sequence = records[position & mask].sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0) {
+			if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				return true;
+			}
+		} else if (difference < 0) {
+			// the slot still holds a line from the previous lap
+			return false;
+		} else {
+			position = tail.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void AsyncLog::run() {
+	std::string batch;
+	FILE* batchTarget = NULL;
+	batch.reserve(BATCH_SIZE);
+
+	while (true) {
+		size_t position = head.load(std::memory_order_relaxed);
+		Record& record = records[position & mask];
+		if (record.sequence.load(std::memory_order_acquire) == position + 1) {
+			if ((record.target != batchTarget) || (batch.size() >= BATCH_SIZE)) {
+				writeBatch(batchTarget, batch);
+				batchTarget = record.target;
+			}
+			if (record.longText != NULL) {
+				batch.append(record.longText, record.length);
+				free(record.longText);
+			} else {
+				batch.append(record.text, record.length);
+			}
+			record.sequence.store(position + mask + 1, std::memory_order_release);
+			head.store(position + 1, std::memory_order_release);
+			continue;
+		}
+
+		// caught up with the producers
+		writeBatch(batchTarget, batch);
+		std::unique_lock<std::mutex> lock(mutex);
+		written = position;
+		producerWake.notify_all();
+		if (stopping && (position == tail.load())) {
+			break;
+		}
+		// sleep out the flush interval unless someone is waiting on us or
+		// the ring is filling up
+		idle = true;
+		drainWake.wait_for(lock, flushInterval, [this] {
+			size_t done = head.load();
+			return (stopping.load() || (drainTarget.load() > done) || (tail.load() - done > mask / 2));
+		});
+		idle = false;
+	}
+}
+
+void AsyncLog::writeBatch(FILE* target, std::string& batch) {
+	if (!batch.empty() && (target != NULL)) {
+		fwrite(batch.data(), 1, batch.size(), target);
+		fflush(target);
+	}
+	batch.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef ASYNCLOG_H_
+#define ASYNCLOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Logger.h"
+
+// Backend of the asynchronous Logger mode. Any number of threads format
+// lines straight into the slots of a bounded ring; claiming a slot is a
+// single compare and swap, so producers never take a lock. One drain thread
+// copies finished lines out in order and hands them to stdio in batches,
+// one write per batch and target, at least once per flush interval.
+class AsyncLog {
+	public:
+		// lines up to this size are stored in the slot itself
+		static const int RECORD_SIZE = 256;
+		AsyncLog(int capacity, int flushInterval, LogOverflowPolicy policy);
+		// writes out everything appended so far, then stops the thread
+		~AsyncLog();
+		void append(FILE* target, const char* fmt, va_list args);
+		// returns once every line appended before the call has been written
+		void drain();
+		uint64_t getDropped();
+
+	private:
+		struct Record {
+			// Vyukov style turn counter: equals the ring position while the
+			// slot is free and position + 1 once the line is published
+			std::atomic<size_t> sequence;
+			FILE* target;
+			int length;
+			// only set for lines longer than text
+			char* longText;
+			char text[RECORD_SIZE];
+		};
+		static const size_t BATCH_SIZE = 65536;
+		bool claim(size_t& position);
+		void wakeDrain();
+		void run();
+		void writeBatch(FILE* target, std::string& batch);
+		std::unique_ptr<Record[]> records;
+		size_t mask;
+		std::atomic<size_t> head, tail;
+		// ring position up to which lines have reached stdio
+		std::atomic<size_t> written;
+		std::atomic<size_t> drainTarget;
+		std::atomic<uint64_t> dropped;
+		std::atomic<bool> stopping;
+		// set while the drain thread sleeps; head does not move meanwhile
+		std::atomic<bool> idle;
+		std::chrono::milliseconds flushInterval;
+		LogOverflowPolicy policy;
+		std::mutex mutex;
+		std::condition_variable drainWake, producerWake;
+		std::thread thread;
+};
+
+#endif // ASYNCLOG_H_
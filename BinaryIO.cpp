@@ -1,7 +1,17 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
+#include <new>
 #include <stdexcept>
 
+#include "AsyncFlusher.h"
 #include "BinaryIO.h"
+#include "BinaryIOStream.h"
+#include "ByteOrder.h"
+#include "Varint.h"
 
 bool BitConverter::forceEndian = false;
 Endian BitConverter::endianOverride = endian;
@@ -84,65 +94,65 @@ vector<byte> BitConverter::getBytes(uint64_t value) {
 	return getBytes8(value);
 }
 
-bool BitConverter::getBool(vector<byte> bytes) {
+bool BitConverter::getBool(const vector<byte>& bytes) {
 	return (bool)getValue1(bytes);
 }
 
-char BitConverter::getChar(vector<byte> bytes) {
+char BitConverter::getChar(const vector<byte>& bytes) {
 	return (char)getValue1(bytes);
 }
 
-signed char BitConverter::getSChar(vector<byte> bytes) {
+signed char BitConverter::getSChar(const vector<byte>& bytes) {
 	return (signed char)getValue1(bytes);
 }
 
-unsigned char BitConverter::getUChar(vector<byte> bytes) {
+unsigned char BitConverter::getUChar(const vector<byte>& bytes) {
 	return (unsigned char)getValue1(bytes);
 }
 
-float BitConverter::getFloat(vector<byte> bytes) {
+float BitConverter::getFloat(const vector<byte>& bytes) {
 	float value;
 	uint32_t valueBytes = getValue4(bytes);
 	memcpy(&value, &valueBytes, 4);
 	return value;
 }
 
-double BitConverter::getDouble(vector<byte> bytes) {
+double BitConverter::getDouble(const vector<byte>& bytes) {
 	double value;
 	uint64_t valueBytes = getValue8(bytes);
 	memcpy(&value, &valueBytes, 8);
 	return value;
 }
 
-int8_t BitConverter::getInt8(vector<byte> bytes) {
+int8_t BitConverter::getInt8(const vector<byte>& bytes) {
 	return (int8_t)getValue1(bytes);
 }
 
-int16_t BitConverter::getInt16(vector<byte> bytes) {
+int16_t BitConverter::getInt16(const vector<byte>& bytes) {
 	return (int16_t)getValue2(bytes);
 }
 
-int32_t BitConverter::getInt32(vector<byte> bytes) {
+int32_t BitConverter::getInt32(const vector<byte>& bytes) {
 	return (int32_t)getValue4(bytes);
 }
 
-int64_t BitConverter::getInt64(vector<byte> bytes) {
+int64_t BitConverter::getInt64(const vector<byte>& bytes) {
 	return (int64_t)getValue8(bytes);
 }
 
-uint8_t BitConverter::getUInt8(vector<byte> bytes) {
+uint8_t BitConverter::getUInt8(const vector<byte>& bytes) {
 	return getValue1(bytes);
 }
 
-uint16_t BitConverter::getUInt16(vector<byte> bytes) {
+uint16_t BitConverter::getUInt16(const vector<byte>& bytes) {
 	return getValue2(bytes);
 }
 
-uint32_t BitConverter::getUInt32(vector<byte> bytes) {
+uint32_t BitConverter::getUInt32(const vector<byte>& bytes) {
 	return getValue4(bytes);
 }
 
-uint64_t BitConverter::getUInt64(vector<byte> bytes) {
+uint64_t BitConverter::getUInt64(const vector<byte>& bytes) {
 	return getValue8(bytes);
 }
 
@@ -195,7 +205,7 @@ vector<byte> BitConverter::getBytes8(uint64_t value) {
 	return retval;
 }
 
-uint8_t BitConverter::getValue1(vector<byte> bytes) {
+uint8_t BitConverter::getValue1(const vector<byte>& bytes) {
 	if (bytes.size() < 1) {
 		throw std::runtime_error("byte vector is too small");
 	}
@@ -203,7 +213,7 @@ uint8_t BitConverter::getValue1(vector<byte> bytes) {
 	return ((uint8_t)bytes[0]);
 }
 
-uint16_t BitConverter::getValue2(vector<byte> bytes) {
+uint16_t BitConverter::getValue2(const vector<byte>& bytes) {
 	if (bytes.size() < 2) {
 		throw std::runtime_error("byte vector is too small");
 	}
@@ -220,7 +230,7 @@ uint16_t BitConverter::getValue2(vector<byte> bytes) {
 	return retval;
 }
 
-uint32_t BitConverter::getValue4(vector<byte> bytes) {
+uint32_t BitConverter::getValue4(const vector<byte>& bytes) {
 	if (bytes.size() < 4) {
 		throw std::runtime_error("byte vector is too small");
 	}
@@ -237,7 +247,7 @@ uint32_t BitConverter::getValue4(vector<byte> bytes) {
 	return retval;
 }
 
-uint64_t BitConverter::getValue8(vector<byte> bytes) {
+uint64_t BitConverter::getValue8(const vector<byte>& bytes) {
 	if (bytes.size() < 8) {
 		throw std::runtime_error("byte vector is too small");
 	}
@@ -254,23 +264,44 @@ uint64_t BitConverter::getValue8(vector<byte> bytes) {
 	return retval;
 }
 
-BinaryIOBase::BinaryIOBase(string fileLocation, ios::openmode mode) {
+// process wide totals, see BinaryIOBase::getGlobalStats
+static std::atomic<uint64_t> globalStats[sizeof(BinaryIOStats) / sizeof(uint64_t)];
+
+static inline uint64_t ioClock() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BinaryIOBase::BinaryIOBase(string fileLocation, ios::openmode mode, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryIOBase(BinaryIOStream::create(backend), fileLocation, mode, bufferSize, bufferAlignment) {
+
+}
+
+BinaryIOBase::BinaryIOBase(BinaryIOStream* stream, string fileLocation, ios::openmode mode, int bufferSize, int bufferAlignment) {
 	bufferPos = 0;
 	bufferDataSize = 0;
+	buffer = NULL;
+	this->bufferAlignment = bufferAlignment;
+	allocateBuffer(std::max(bufferSize, (int)MIN_BUFFERSIZE));
 	lastError = None;
 	forceEndian = false;
+	adaptiveMaxSize = 0;
+	sequentialChunks = 0;
+	memset(&stats, 0, sizeof(stats));
 	this->fileLocation = fileLocation;
 	this->mode = mode;
-	stream.open(this->fileLocation, this->mode);
-	if (!stream.is_open()) {
-		lastError = CannotOpenFile;
-	}
+	this->stream = stream;
+	lastError = this->stream->open(this->fileLocation, this->mode);
 }
 
 BinaryIOBase::~BinaryIOBase() {
-	if (stream.is_open()) {
-		stream.close();
+	const uint64_t* counters = (const uint64_t*)&stats;
+	for (size_t i = 0; i < sizeof(BinaryIOStats) / sizeof(uint64_t); i++) {
+		if (counters[i] != 0) {
+			globalStats[i].fetch_add(counters[i], std::memory_order_relaxed);
+		}
 	}
+
+	delete stream;
+	free(buffer);
 }
 
 bool BinaryIOBase::hasError() {
@@ -295,12 +326,97 @@ bool BinaryIOBase::isLittleEndian() {
 	return (!forceEndian ? endian : endianOverride);
 }
 
-BinaryReader::BinaryReader(const char* fileLocation) : BinaryIOBase(string(fileLocation), ios::in | ios::binary) {
-	
+bool BinaryIOBase::needsByteSwap() {
+	return (isLittleEndian() != (endian == Little));
 }
 
-BinaryReader::BinaryReader(string fileLocation) : BinaryIOBase(fileLocation, ios::in | ios::binary) {
-	
+int BinaryIOBase::getBufferSize() {
+	return bufferSize;
+}
+
+BinaryIOStream* BinaryIOBase::getStream() {
+	return stream;
+}
+
+void BinaryIOBase::enableAdaptiveBuffer(int maxBufferSize) {
+	adaptiveMaxSize = maxBufferSize;
+	sequentialChunks = 0;
+}
+
+void BinaryIOBase::disableAdaptiveBuffer() {
+	adaptiveMaxSize = 0;
+	sequentialChunks = 0;
+}
+
+BinaryIOStats BinaryIOBase::getStats() {
+	return stats;
+}
+
+void BinaryIOBase::resetStats() {
+	memset(&stats, 0, sizeof(stats));
+}
+
+BinaryIOStats BinaryIOBase::getGlobalStats() {
+	BinaryIOStats totals;
+	uint64_t* counters = (uint64_t*)&totals;
+	for (size_t i = 0; i < sizeof(BinaryIOStats) / sizeof(uint64_t); i++) {
+		counters[i] = globalStats[i].load(std::memory_order_relaxed);
+	}
+	return totals;
+}
+
+void BinaryIOBase::resetGlobalStats() {
+	for (size_t i = 0; i < sizeof(BinaryIOStats) / sizeof(uint64_t); i++) {
+		globalStats[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+// Must only be called while the buffer holds no live data, as growing it
+// discards the contents.
+void BinaryIOBase::adaptBuffer(bool fullChunk) {
+	sequentialChunks = fullChunk ? (sequentialChunks + 1) : 0;
+	if ((bufferSize >= adaptiveMaxSize) || (sequentialChunks < ADAPTIVE_RUNLENGTH)) {
+		return;
+	}
+
+	allocateBuffer(std::min(bufferSize * 2, adaptiveMaxSize));
+	sequentialChunks = 0;
+}
+
+void BinaryIOBase::allocateBuffer(int size) {
+	void* memory = NULL;
+	if (bufferAlignment > 0) {
+		if (posix_memalign(&memory, bufferAlignment, size) != 0) {
+			memory = NULL;
+		}
+	} else {
+		memory = malloc(size);
+	}
+	if (memory == NULL) {
+		throw std::bad_alloc();
+	}
+
+	free(buffer);
+	buffer = (char*)memory;
+	bufferSize = size;
+}
+
+BinaryReader::BinaryReader(const char* fileLocation, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryIOBase(string(fileLocation), ios::in | ios::binary, bufferSize, bufferAlignment, backend) {
+	endOfFile = false;
+	streamOffset = 0;
+	stream->advise(AdviseSequential);
+}
+
+BinaryReader::BinaryReader(string fileLocation, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryIOBase(fileLocation, ios::in | ios::binary, bufferSize, bufferAlignment, backend) {
+	endOfFile = false;
+	streamOffset = 0;
+	stream->advise(AdviseSequential);
+}
+
+BinaryReader::BinaryReader(BinaryIOStream* stream, string fileLocation, int bufferSize, int bufferAlignment) : BinaryIOBase(stream, fileLocation, ios::in | ios::binary, bufferSize, bufferAlignment) {
+	endOfFile = false;
+	streamOffset = 0;
+	stream->advise(AdviseSequential);
 }
 
 BinaryReader::~BinaryReader() {
@@ -308,31 +424,40 @@ BinaryReader::~BinaryReader() {
 }
 
 bool BinaryReader::moreData() {
-	return (!stream.eof() || (bufferPos != bufferDataSize));
+	if ((bufferPos >= bufferDataSize) && !hasError()) {
+		readNextChunk();
+	}
+	return (bufferPos < bufferDataSize);
 }
 
 bool BinaryReader::readBool() {
+	stats.values[BoolValue]++;
 	uint8_t value = read1();
 	return ((value == 0) ? false : true);
 }
 
 byte BinaryReader::readByte() {
+	stats.values[UInt8Value]++;
 	return (byte)read1();
 }
 
 char BinaryReader::readChar() {
+	stats.values[CharValue]++;
 	return (char)read1();
 }
 
 signed char BinaryReader::readSChar() {
+	stats.values[CharValue]++;
 	return (signed char)read1();
 }
 
 unsigned char BinaryReader::readUChar() {
+	stats.values[CharValue]++;
 	return (unsigned char)read1();
 }
 
 float BinaryReader::readFloat() {
+	stats.values[FloatValue]++;
 	float value;
 	uint32_t valueBytes = read4();
 	memcpy(&value, &valueBytes, 4);
@@ -340,6 +465,7 @@ float BinaryReader::readFloat() {
 }
 
 double BinaryReader::readDouble() {
+	stats.values[DoubleValue]++;
 	double value;
 	uint64_t valueBytes = read8();
 	memcpy(&value, &valueBytes, 8);
@@ -347,48 +473,356 @@ double BinaryReader::readDouble() {
 }
 
 int8_t BinaryReader::readInt8() {
+	stats.values[Int8Value]++;
 	return (int8_t)read1();
 }
 
 int16_t BinaryReader::readInt16() {
+	stats.values[Int16Value]++;
 	return (int16_t)read2();
 }
 
 int32_t BinaryReader::readInt32() {
+	stats.values[Int32Value]++;
 	return (int32_t)read4();
 }
 
 int64_t BinaryReader::readInt64() {
+	stats.values[Int64Value]++;
 	return (int64_t)read8();
 }
 
 uint8_t BinaryReader::readUInt8() {
+	stats.values[UInt8Value]++;
 	return read1();
 }
 
 uint16_t BinaryReader::readUInt16() {
+	stats.values[UInt16Value]++;
 	return read2();
 }
 
 uint32_t BinaryReader::readUInt32() {
+	stats.values[UInt32Value]++;
 	return read4();
 }
 
 uint64_t BinaryReader::readUInt64() {
+	stats.values[UInt64Value]++;
 	return read8();
 }
 
 vector<byte> BinaryReader::readBytes(int count) {
-	vector<byte> bytes = vector<byte>(count);
+	vector<byte> bytes = vector<byte>((count > 0) ? count : 0);
 
-	for (int i = 0; i < count; i++) {
-		bytes[i] = readByte();
+	readRaw(bytes.data(), bytes.size());
+	if (hasError()) {
+		return vector<byte>(0);
+	}
+
+	return bytes;
+}
+
+ByteView BinaryReader::readBytesView(int count) {
+	if (hasError() || (count <= 0) || (count > bufferSize)) {
+		return ByteView { NULL, 0 };
+	}
+	if (!ensureBuffered(count)) {
+		if (!hasError()) {
+			lastError = NotEnoughData;
+		}
+		return ByteView { NULL, 0 };
+	}
+
+	ByteView view = { (const byte*)buffer + bufferPos, (size_t)count };
+	bufferPos += count;
+	return view;
+}
+
+int BinaryReader::readInto(byte* bytes, int count) {
+	if (hasError() || (count <= 0)) {
+		return 0;
+	}
+
+	return (int)readRaw(bytes, count);
+}
+
+void BinaryReader::readInto(vector<byte>& bytes, int count) {
+	// resize keeps the existing capacity, so a reused vector never reallocates
+	bytes.resize((count > 0) ? count : 0);
+	bytes.resize(readInto(bytes.data(), count));
+}
+
+void BinaryReader::readArray(float* values, int count) {
+	stats.values[FloatValue] += std::max(count, 0);
+	readArrayN(values, count, 4);
+}
+
+void BinaryReader::readArray(double* values, int count) {
+	stats.values[DoubleValue] += std::max(count, 0);
+	readArrayN(values, count, 8);
+}
+
+void BinaryReader::readArray(int8_t* values, int count) {
+	stats.values[Int8Value] += std::max(count, 0);
+	readArrayN(values, count, 1);
+}
+
+void BinaryReader::readArray(int16_t* values, int count) {
+	stats.values[Int16Value] += std::max(count, 0);
+	readArrayN(values, count, 2);
+}
+
+void BinaryReader::readArray(int32_t* values, int count) {
+	stats.values[Int32Value] += std::max(count, 0);
+	readArrayN(values, count, 4);
+}
+
+void BinaryReader::readArray(int64_t* values, int count) {
+	stats.values[Int64Value] += std::max(count, 0);
+	readArrayN(values, count, 8);
+}
+
+void BinaryReader::readArray(uint8_t* values, int count) {
+	stats.values[UInt8Value] += std::max(count, 0);
+	readArrayN(values, count, 1);
+}
+
+void BinaryReader::readArray(uint16_t* values, int count) {
+	stats.values[UInt16Value] += std::max(count, 0);
+	readArrayN(values, count, 2);
+}
+
+void BinaryReader::readArray(uint32_t* values, int count) {
+	stats.values[UInt32Value] += std::max(count, 0);
+	readArrayN(values, count, 4);
+}
+
+void BinaryReader::readArray(uint64_t* values, int count) {
+	stats.values[UInt64Value] += std::max(count, 0);
+	readArrayN(values, count, 8);
+}
+
+uint64_t BinaryReader::readVarUInt() {
+	if (hasError()) {
+		return 0;
+	}
+	stats.values[VarintValue]++;
+	return readVarN();
+}
+
+uint64_t BinaryReader::readVarN() {
+	uint64_t value = 0;
+	if (bufferDataSize - bufferPos >= VARINT_MAXSIZE) {
+		int size = decodeVarint((const uint8_t*)buffer + bufferPos, VARINT_MAXSIZE, value);
+		if (size == 0) {
+			lastError = InvalidData;
+			return 0;
+		}
+		bufferPos += size;
+		return value;
+	}
+
+	// too close to the end of the buffer to decode in place
+	for (int i = 0; i < VARINT_MAXSIZE; i++) {
+		uint8_t next = read1();
 		if (hasError()) {
-			return vector<byte>(0);
+			return 0;
+		}
+		value |= (uint64_t)(next & 0x7F) << (7 * i);
+		if ((next & 0x80) == 0) {
+			return value;
 		}
 	}
 
-	return bytes;
+	lastError = InvalidData;
+	return 0;
+}
+
+int64_t BinaryReader::readVarInt() {
+	return zigzagDecode(readVarUInt());
+}
+
+void BinaryReader::readVarUIntArray(uint32_t* values, int count) {
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+	stats.values[VarintValue] += count;
+
+	vector<uint8_t> control(streamVByteControlSize(count));
+	readRaw(control.data(), control.size());
+	if (hasError()) {
+		return;
+	}
+
+	// decode straight from the buffer in pieces whose payload, at most 16
+	// bytes per group, always fits in it
+	int pieceCount = 4 * std::max(bufferSize / 16, 1);
+	for (int done = 0; done < count; done += pieceCount) {
+		int pieceValues = std::min(pieceCount, count - done);
+		const uint8_t* pieceControl = control.data() + done / 4;
+		int size = (int)streamVByteDataSize(pieceControl, pieceValues);
+		if (!ensureBuffered(size)) {
+			if (!hasError()) {
+				lastError = NotEnoughData;
+			}
+			return;
+		}
+
+		streamVByteDecode(pieceControl, (const uint8_t*)buffer + bufferPos, bufferDataSize - bufferPos, pieceValues, values + done);
+		bufferPos += size;
+	}
+}
+
+void BinaryReader::readVarIntArray(int32_t* values, int count) {
+	readVarUIntArray((uint32_t*)values, count);
+	for (int i = 0; i < count; i++) {
+		values[i] = zigzagDecode32((uint32_t)values[i]);
+	}
+}
+
+std::string_view BinaryReader::readStringView(StringPrefix prefix) {
+	int length = readStringLength(prefix);
+	if (hasError() || (length == 0)) {
+		return std::string_view();
+	}
+
+	if (length <= bufferSize) {
+		if (!ensureBuffered(length)) {
+			if (!hasError()) {
+				lastError = NotEnoughData;
+			}
+			return std::string_view();
+		}
+		std::string_view view(buffer + bufferPos, length);
+		bufferPos += length;
+		return view;
+	}
+
+	stringScratch.resize(length);
+	if (readRaw(&stringScratch[0], length) != (size_t)length) {
+		return std::string_view();
+	}
+	return std::string_view(stringScratch);
+}
+
+void BinaryReader::readString(string& value, StringPrefix prefix) {
+	int length = readStringLength(prefix);
+	// resize keeps the existing capacity, so a reused string never reallocates
+	value.resize(length);
+	if (length > 0) {
+		value.resize(readRaw(&value[0], length));
+	}
+}
+
+string BinaryReader::readString(StringPrefix prefix) {
+	string value;
+	readString(value, prefix);
+	return value;
+}
+
+int BinaryReader::readStringLength(StringPrefix prefix) {
+	if (hasError()) {
+		return 0;
+	}
+	stats.values[StringValue]++;
+
+	uint64_t length;
+	switch (prefix) {
+		case UInt16Prefix:
+			length = read2();
+			break;
+		case UInt32Prefix:
+			length = read4();
+			break;
+		case VarintPrefix:
+		default:
+			// the prefix is part of the string, not a value of its own
+			length = readVarN();
+			break;
+	}
+	if (hasError()) {
+		return 0;
+	}
+	if (length > (uint64_t)INT_MAX) {
+		lastError = InvalidData;
+		return 0;
+	}
+
+	return (int)length;
+}
+
+uint64_t BinaryReader::tell() {
+	return streamOffset - (bufferDataSize - bufferPos);
+}
+
+bool BinaryReader::seek(uint64_t offset) {
+	if ((lastError != None) && (lastError != NotEnoughData)) {
+		return false;
+	}
+
+	uint64_t windowStart = streamOffset - bufferDataSize;
+	if ((offset >= windowStart) && (offset <= streamOffset)) {
+		bufferPos = (int)(offset - windowStart);
+		lastError = None;
+		return true;
+	}
+
+	if (!stream->isOpen()) {
+		lastError = GenericReadError;
+		return false;
+	}
+	uint64_t start = ioClock();
+	bool moved = stream->seek(offset);
+	stats.streamCalls++;
+	stats.ioNanoseconds += ioClock() - start;
+	if (!moved) {
+		lastError = GenericReadError;
+		return false;
+	}
+	bufferPos = 0;
+	bufferDataSize = 0;
+	streamOffset = offset;
+	endOfFile = false;
+	lastError = None;
+	// a jump breaks the sequential run the adaptive buffer is looking for
+	adaptBuffer(false);
+	return true;
+}
+
+bool BinaryReader::skip(uint64_t count) {
+	return seek(tell() + count);
+}
+
+int BinaryReader::readAt(uint64_t offset, byte* bytes, int count) {
+	if (hasError() || (count <= 0)) {
+		return 0;
+	}
+
+	uint64_t windowStart = streamOffset - bufferDataSize;
+	if ((offset >= windowStart) && (offset + count <= streamOffset)) {
+		memcpy(bytes, buffer + (offset - windowStart), count);
+		return count;
+	}
+
+	int copied = 0;
+	while (copied < count) {
+		uint64_t start = ioClock();
+		int64_t chunk = stream->readAt((char*)bytes + copied, count - copied, offset + copied);
+		stats.streamCalls++;
+		stats.ioNanoseconds += ioClock() - start;
+		if (chunk < 0) {
+			lastError = GenericReadError;
+			return copied;
+		}
+		if (chunk == 0) {
+			break;
+		}
+		copied += chunk;
+		stats.bytesRead += chunk;
+	}
+
+	return copied;
 }
 
 uint8_t BinaryReader::read1() {
@@ -397,7 +831,10 @@ uint8_t BinaryReader::read1() {
 		readNextChunk();
 	}
 	if (!moreData()) {
-		lastError = NotEnoughData;
+		// keep a more specific error reported by the stream
+		if (!hasError()) {
+			lastError = NotEnoughData;
+		}
 		return value;
 	}
 
@@ -457,32 +894,154 @@ uint64_t BinaryReader::read8() {
 	return value;
 }
 
+void BinaryReader::readArrayN(void* values, int count, int size) {
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+
+	readRaw(values, (size_t)count * size);
+	if (hasError() || !needsByteSwap()) {
+		return;
+	}
+
+	switch (size) {
+		case 2:
+			swapCopy2(values, values, count);
+			break;
+		case 4:
+			swapCopy4(values, values, count);
+			break;
+		case 8:
+			swapCopy8(values, values, count);
+			break;
+	}
+}
+
+size_t BinaryReader::readRaw(void* dst, size_t count) {
+	byte* out = (byte*)dst;
+	size_t copied = 0;
+
+	while (copied < count) {
+		if ((bufferPos >= bufferDataSize) && (count - copied >= (size_t)bufferSize)) {
+			// the buffer is drained and the rest would not fit anyway, so
+			// read straight into the destination; the stale window goes
+			bufferPos = 0;
+			bufferDataSize = 0;
+			int chunk = readChunk((char*)out + copied, (int)std::min(count - copied, (size_t)INT_MAX));
+			if (chunk < 0) {
+				return copied;
+			}
+			if (chunk == 0) {
+				lastError = NotEnoughData;
+				return copied;
+			}
+			copied += chunk;
+			continue;
+		}
+		if (bufferPos >= bufferDataSize) {
+			readNextChunk();
+			if (hasError()) {
+				return copied;
+			}
+			if (bufferDataSize == 0) {
+				lastError = NotEnoughData;
+				return copied;
+			}
+		}
+
+		size_t chunk = std::min(count - copied, (size_t)(bufferDataSize - bufferPos));
+		memcpy(out + copied, buffer + bufferPos, chunk);
+		bufferPos += chunk;
+		copied += chunk;
+	}
+
+	return copied;
+}
+
+bool BinaryReader::ensureBuffered(int count) {
+	if (bufferDataSize - bufferPos >= count) {
+		return true;
+	}
+
+	// move the unread tail to the front and top the buffer up behind it
+	int remaining = bufferDataSize - bufferPos;
+	memmove(buffer, buffer + bufferPos, remaining);
+	bufferPos = 0;
+	bufferDataSize = remaining;
+
+	while (bufferDataSize < count) {
+		int chunk = readChunk(buffer + bufferDataSize, bufferSize - bufferDataSize);
+		if (chunk <= 0) {
+			return false;
+		}
+		bufferDataSize += chunk;
+	}
+
+	return true;
+}
+
+int BinaryReader::readChunk(char* dst, int count) {
+	if (!stream->isOpen() || endOfFile) {
+		return 0;
+	}
+
+	uint64_t start = ioClock();
+	int64_t chunk = stream->read(dst, count);
+	stats.streamCalls++;
+	stats.ioNanoseconds += ioClock() - start;
+	if (chunk < 0) {
+		BinaryIOError cause = stream->getError();
+		lastError = (cause != None) ? cause : GenericReadError;
+		return -1;
+	}
+	if (chunk == 0) {
+		endOfFile = true;
+	}
+	streamOffset += chunk;
+	stats.bytesRead += chunk;
+
+	return (int)chunk;
+}
+
 void BinaryReader::readNextChunk() {
+	stats.refills++;
+	adaptBuffer((bufferDataSize == bufferSize) && (bufferPos >= bufferDataSize));
 	bufferPos = 0;
 	bufferDataSize = 0;
-	if (stream.is_open()) {
-		stream.readsome(buffer, BUFFERMAX);
-		if (stream.fail() || stream.bad()) {
-			lastError = GenericReadError;
-			return;
+
+	// backends may return short reads, so keep going until the buffer is
+	// full or the file ends
+	while (bufferDataSize < bufferSize) {
+		int chunk = readChunk(buffer + bufferDataSize, bufferSize - bufferDataSize);
+		if (chunk <= 0) {
+			break;
 		}
-		bufferDataSize = stream.gcount();
+		bufferDataSize += chunk;
 	}
 }
 
-BinaryWriter::BinaryWriter(const char* fileLocation, bool overwrite) : BinaryIOBase(string(fileLocation), ios::out | ios::binary | (overwrite ? ios::trunc : ios::app)) {
-
+BinaryWriter::BinaryWriter(const char* fileLocation, bool overwrite, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryIOBase(string(fileLocation), ios::out | ios::binary | (overwrite ? ios::trunc : ios::app), bufferSize, bufferAlignment, backend) {
+	flusher = NULL;
+	streamOffset = 0;
 }
 
-BinaryWriter::BinaryWriter(string fileLocation, bool overwrite) : BinaryIOBase(fileLocation, ios::out | ios::binary | (overwrite ? ios::trunc : ios::app)) {
+BinaryWriter::BinaryWriter(string fileLocation, bool overwrite, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryIOBase(fileLocation, ios::out | ios::binary | (overwrite ? ios::trunc : ios::app), bufferSize, bufferAlignment, backend) {
+	flusher = NULL;
+	streamOffset = 0;
+}
 
+BinaryWriter::BinaryWriter(BinaryIOStream* stream, string fileLocation, bool overwrite, int bufferSize, int bufferAlignment) : BinaryIOBase(stream, fileLocation, ios::out | ios::binary | (overwrite ? ios::trunc : ios::app), bufferSize, bufferAlignment) {
+	flusher = NULL;
+	streamOffset = 0;
 }
 
 BinaryWriter::~BinaryWriter() {
 	flush();
+	delete flusher;
 }
 
 void BinaryWriter::write(bool value) {
+	stats.values[BoolValue]++;
 	write1((uint8_t)value);
 }
 
@@ -493,24 +1052,29 @@ void BinaryWriter::write(byte value) {
 */
 
 void BinaryWriter::write(char value) {
+	stats.values[CharValue]++;
 	write1((uint8_t)value);
 }
 
 void BinaryWriter::write(signed char value) {
+	stats.values[CharValue]++;
 	write1((uint8_t)value);
 }
 
 void BinaryWriter::write(unsigned char value) {
+	stats.values[CharValue]++;
 	write1((uint8_t)value);
 }
 
 void BinaryWriter::write(float value) {
+	stats.values[FloatValue]++;
 	uint32_t valueBytes;
 	memcpy(&valueBytes, &value, 4);
 	write4(valueBytes);
 }
 
 void BinaryWriter::write(double value) {
+	stats.values[DoubleValue]++;
 	uint64_t valueBytes;
 	memcpy(&valueBytes, &value, 8);
 	write8(valueBytes);
@@ -523,14 +1087,17 @@ void BinaryWriter::write(int8_t value) {
 */
 
 void BinaryWriter::write(int16_t value) {
+	stats.values[Int16Value]++;
 	write2((uint16_t)value);
 }
 
 void BinaryWriter::write(int32_t value) {
+	stats.values[Int32Value]++;
 	write4((uint32_t)value);
 }
 
 void BinaryWriter::write(int64_t value) {
+	stats.values[Int64Value]++;
 	write8((uint64_t)value);
 }
 
@@ -541,37 +1108,85 @@ void BinaryWriter::write(uint8_t value) {
 */
 
 void BinaryWriter::write(uint16_t value) {
+	stats.values[UInt16Value]++;
 	write2(value);
 }
 
 void BinaryWriter::write(uint32_t value) {
+	stats.values[UInt32Value]++;
 	write4(value);
 }
 
 void BinaryWriter::write(uint64_t value) {
+	stats.values[UInt64Value]++;
 	write8(value);
 }
 
-void BinaryWriter::write(vector<byte> bytes) {
+void BinaryWriter::write(const vector<byte>& bytes) {
 	write(bytes, 0, bytes.size());
 }
 
-void BinaryWriter::write(vector<byte> bytes, int start, int count) {
-	if ((start >= bytes.size()) || (start + count > bytes.size())) {
+void BinaryWriter::write(const vector<byte>& bytes, int start, int count) {
+	if ((start < 0) || (count < 0) || ((size_t)start >= bytes.size()) || ((size_t)count > bytes.size() - start)) {
 		lastError = NotEnoughData;
 		return;
 	}
 
-	for (int i = start; i < (start + count); i++) {
-		if (hasError()) {
-			return;
-		}
-		write1((uint8_t)bytes[i]);
-	}
+	writeRaw(bytes.data() + start, count);
+}
+
+void BinaryWriter::writeArray(const float* values, int count) {
+	stats.values[FloatValue] += std::max(count, 0);
+	writeArrayN(values, count, 4);
+}
+
+void BinaryWriter::writeArray(const double* values, int count) {
+	stats.values[DoubleValue] += std::max(count, 0);
+	writeArrayN(values, count, 8);
+}
+
+void BinaryWriter::writeArray(const int8_t* values, int count) {
+	stats.values[Int8Value] += std::max(count, 0);
+	writeArrayN(values, count, 1);
+}
+
+void BinaryWriter::writeArray(const int16_t* values, int count) {
+	stats.values[Int16Value] += std::max(count, 0);
+	writeArrayN(values, count, 2);
+}
+
+void BinaryWriter::writeArray(const int32_t* values, int count) {
+	stats.values[Int32Value] += std::max(count, 0);
+	writeArrayN(values, count, 4);
+}
+
+void BinaryWriter::writeArray(const int64_t* values, int count) {
+	stats.values[Int64Value] += std::max(count, 0);
+	writeArrayN(values, count, 8);
+}
+
+void BinaryWriter::writeArray(const uint8_t* values, int count) {
+	stats.values[UInt8Value] += std::max(count, 0);
+	writeArrayN(values, count, 1);
+}
+
+void BinaryWriter::writeArray(const uint16_t* values, int count) {
+	stats.values[UInt16Value] += std::max(count, 0);
+	writeArrayN(values, count, 2);
+}
+
+void BinaryWriter::writeArray(const uint32_t* values, int count) {
+	stats.values[UInt32Value] += std::max(count, 0);
+	writeArrayN(values, count, 4);
+}
+
+void BinaryWriter::writeArray(const uint64_t* values, int count) {
+	stats.values[UInt64Value] += std::max(count, 0);
+	writeArrayN(values, count, 8);
 }
 
 void BinaryWriter::write1(uint8_t value) {
-	if (bufferPos >= BUFFERMAX) {
+	if (bufferPos >= bufferSize) {
 		flush();
 	}
 	if (hasError()) {
@@ -621,13 +1236,236 @@ void BinaryWriter::write8(uint64_t value) {
 	}
 }
 
+void BinaryWriter::writeArrayN(const void* values, int count, int size) {
+	const byte* in = (const byte*)values;
+	size_t remaining = (count > 0) ? (size_t)count * size : 0;
+
+	if ((size == 1) || !needsByteSwap()) {
+		writeRaw(values, remaining);
+		return;
+	}
+
+	while (remaining > 0) {
+		if (bufferSize - bufferPos < size) {
+			flush();
+		}
+		if (hasError()) {
+			return;
+		}
+
+		// only whole elements can be swapped
+		size_t chunk = std::min(remaining, (size_t)(bufferSize - bufferPos));
+		chunk -= chunk % size;
+		switch (size) {
+			case 2:
+				swapCopy2(buffer + bufferPos, in, chunk / 2);
+				break;
+			case 4:
+				swapCopy4(buffer + bufferPos, in, chunk / 4);
+				break;
+			case 8:
+				swapCopy8(buffer + bufferPos, in, chunk / 8);
+				break;
+		}
+		bufferPos += chunk;
+		in += chunk;
+		remaining -= chunk;
+	}
+}
+
+void BinaryWriter::writeRaw(const void* src, size_t count) {
+	const byte* in = (const byte*)src;
+
+	while (count > 0) {
+		if (hasError()) {
+			return;
+		}
+		if ((flusher == NULL) && (bufferPos == 0) && (count >= (size_t)bufferSize)) {
+			// nothing is buffered and the rest would not fit anyway, so
+			// write straight from the caller's memory
+			size_t chunk = std::min(count, (size_t)INT_MAX);
+			writeChunk((const char*)in, chunk);
+			in += chunk;
+			count -= chunk;
+			continue;
+		}
+		if (bufferPos >= bufferSize) {
+			flush();
+			continue;
+		}
+
+		size_t chunk = std::min(count, (size_t)(bufferSize - bufferPos));
+		memcpy(buffer + bufferPos, in, chunk);
+		bufferPos += chunk;
+		in += chunk;
+		count -= chunk;
+	}
+}
+
+void BinaryWriter::writeVarUInt(uint64_t value) {
+	if (hasError()) {
+		return;
+	}
+	stats.values[VarintValue]++;
+	writeVarN(value);
+}
+
+void BinaryWriter::writeVarN(uint64_t value) {
+	if (bufferSize - bufferPos >= VARINT_MAXSIZE) {
+		bufferPos += encodeVarint(value, (uint8_t*)buffer + bufferPos);
+		return;
+	}
+
+	uint8_t bytes[VARINT_MAXSIZE];
+	writeRaw(bytes, encodeVarint(value, bytes));
+}
+
+void BinaryWriter::writeVarInt(int64_t value) {
+	writeVarUInt(zigzagEncode(value));
+}
+
+void BinaryWriter::writeVarUIntArray(const uint32_t* values, int count) {
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+	stats.values[VarintValue] += count;
+
+	size_t controlSize = streamVByteControlSize(count);
+	vector<uint8_t> encoded(controlSize + streamVByteMaxDataSize(count));
+	size_t size = streamVByteEncode(values, count, encoded.data(), encoded.data() + controlSize);
+	writeRaw(encoded.data(), controlSize + size);
+}
+
+void BinaryWriter::writeVarIntArray(const int32_t* values, int count) {
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+
+	vector<uint32_t> mapped(count);
+	for (int i = 0; i < count; i++) {
+		mapped[i] = zigzagEncode32(values[i]);
+	}
+	writeVarUIntArray(mapped.data(), count);
+}
+
+void BinaryWriter::writeString(std::string_view value, StringPrefix prefix) {
+	if (hasError()) {
+		return;
+	}
+	stats.values[StringValue]++;
+
+	switch (prefix) {
+		case UInt16Prefix:
+			if (value.size() > UINT16_MAX) {
+				lastError = InvalidData;
+				return;
+			}
+			write2((uint16_t)value.size());
+			break;
+		case UInt32Prefix:
+			if (value.size() > UINT32_MAX) {
+				lastError = InvalidData;
+				return;
+			}
+			write4((uint32_t)value.size());
+			break;
+		case VarintPrefix:
+		default:
+			// the prefix is part of the string, not a value of its own
+			writeVarN(value.size());
+			break;
+	}
+
+	writeRaw(value.data(), value.size());
+}
+
+void BinaryWriter::enableAsyncFlush(int bufferCount) {
+	if ((flusher != NULL) || hasError()) {
+		return;
+	}
+
+	flush();
+	disableAdaptiveBuffer();
+	flusher = new AsyncFlusher(stream, std::max(bufferCount, 1), bufferSize, bufferAlignment);
+}
+
+void BinaryWriter::disableAsyncFlush() {
+	if (flusher == NULL) {
+		return;
+	}
+
+	sync();
+	delete flusher;
+	flusher = NULL;
+}
+
+void BinaryWriter::sync() {
+	flush();
+	if (flusher != NULL) {
+		uint64_t start = ioClock();
+		flusher->drain();
+		stats.ioNanoseconds += ioClock() - start;
+		if (flusher->getError() != None) {
+			lastError = flusher->getError();
+		}
+	}
+}
+
+uint64_t BinaryWriter::tell() {
+	return streamOffset + bufferPos;
+}
+
+// Called with an empty buffer too, e.g. from sync() and the destructor. The
+// stream still gets a zero byte write() then, so a backend that holds data
+// back until it is next written to can push it out; that call is not
+// counted in the stats.
 void BinaryWriter::flush() {
-	if (stream.is_open()) {
-		stream.write(buffer, bufferPos);
+	if (bufferPos > 0) {
+		stats.flushes++;
+	}
+	if (flusher != NULL) {
+		// swap the full buffer for an empty one; the stream is only touched
+		// from the flusher thread from here on. Each block is one write
+		// there, and the time counted is what this thread waited for
+		uint64_t start = ioClock();
+		stats.streamCalls += (bufferPos > 0) ? 1 : 0;
+		stats.bytesWritten += bufferPos;
+		streamOffset += bufferPos;
+		buffer = flusher->submit(buffer, bufferPos);
+		stats.ioNanoseconds += ioClock() - start;
 		bufferPos = 0;
-		if (stream.fail() || stream.bad()) {
-			lastError = GenericWriteError;
+		if (flusher->getError() != None) {
+			lastError = flusher->getError();
 		}
+		return;
+	}
+
+	if (stream->isOpen()) {
+		bool fullChunk = (bufferPos == bufferSize);
+		writeChunk(buffer, bufferPos);
+		bufferPos = 0;
+		if (hasError()) {
+			return;
+		}
+		adaptBuffer(fullChunk);
+	}
+}
+
+void BinaryWriter::writeChunk(const char* src, size_t count) {
+	if (!stream->isOpen()) {
+		return;
+	}
+
+	uint64_t start = ioClock();
+	int64_t written = stream->write(src, count);
+	// an empty flush moves no bytes and is not counted
+	stats.streamCalls += (count > 0) ? 1 : 0;
+	stats.ioNanoseconds += ioClock() - start;
+	if (written < 0) {
+		lastError = GenericWriteError;
+		return;
 	}
+	stats.bytesWritten += count;
+	streamOffset += count;
 }
 
@@ -1,10 +1,13 @@
 #ifndef __BINARYIO_H__
 #define __BINARYIO_H__
 
-// #include <cstddef>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #define byte unsigned char
@@ -20,6 +23,20 @@ enum Endian {
     Little,
 };
 
+enum BinaryIOBackend {
+	DefaultBackend,
+	PosixBackend,
+	FstreamBackend,
+	IoUringBackend,
+};
+
+// length prefix in front of strings; fixed widths follow the file byte order
+enum StringPrefix {
+	UInt16Prefix,
+	UInt32Prefix,
+	VarintPrefix,
+};
+
 enum BinaryIOError {
 	None,
 	GenericReadError,
@@ -27,6 +44,52 @@ enum BinaryIOError {
 	CannotOpenFile,
 	FileDoesNotExist,
 	NotEnoughData,
+	InvalidData,
+	ChecksumMismatch,
+};
+
+// non-owning view of bytes held by a reader; only valid until the reader is
+// advanced or destroyed
+struct ByteView {
+	const byte* data;
+	size_t size;
+
+	const byte* begin() const { return data; }
+	const byte* end() const { return data + size; }
+	bool empty() const { return (size == 0); }
+};
+
+// value kinds tallied by BinaryIOStats; bulk calls count every element
+enum BinaryIOValueType {
+	BoolValue,
+	CharValue,
+	FloatValue,
+	DoubleValue,
+	Int8Value,
+	Int16Value,
+	Int32Value,
+	Int64Value,
+	UInt8Value,
+	UInt16Value,
+	UInt32Value,
+	UInt64Value,
+	VarintValue,
+	StringValue,
+	RecordValue,
+	ValueTypeCount,
+};
+
+// I/O counters of a reader or writer. streamCalls is the number of reads,
+// writes and seeks issued to the stream, which is one syscall each for the
+// file backends, and ioNanoseconds the time spent waiting on them
+struct BinaryIOStats {
+	uint64_t bytesRead;
+	uint64_t bytesWritten;
+	uint64_t refills;
+	uint64_t flushes;
+	uint64_t streamCalls;
+	uint64_t ioNanoseconds;
+	uint64_t values[ValueTypeCount];
 };
 
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
@@ -58,20 +121,50 @@ class BitConverter {
 		static vector<byte> getBytes(uint32_t value);
 		static vector<byte> getBytes(uint64_t value);
 		// from bytes
-		static bool getBool(vector<byte> bytes);
-		static char getChar(vector<byte> bytes);
-		static signed char getSChar(vector<byte> bytes);
-		static unsigned char getUChar(vector<byte> bytes);
-		static float getFloat(vector<byte> bytes);
-		static double getDouble(vector<byte> bytes);
-		static int8_t getInt8(vector<byte> bytes);
-		static int16_t getInt16(vector<byte> bytes);
-		static int32_t getInt32(vector<byte> bytes);
-		static int64_t getInt64(vector<byte> bytes);
-		static uint8_t getUInt8(vector<byte> bytes);
-		static uint16_t getUInt16(vector<byte> bytes);
-		static uint32_t getUInt32(vector<byte> bytes);
-		static uint64_t getUInt64(vector<byte> bytes);
+		static bool getBool(const vector<byte>& bytes);
+		static char getChar(const vector<byte>& bytes);
+		static signed char getSChar(const vector<byte>& bytes);
+		static unsigned char getUChar(const vector<byte>& bytes);
+		static float getFloat(const vector<byte>& bytes);
+		static double getDouble(const vector<byte>& bytes);
+		static int8_t getInt8(const vector<byte>& bytes);
+		static int16_t getInt16(const vector<byte>& bytes);
+		static int32_t getInt32(const vector<byte>& bytes);
+		static int64_t getInt64(const vector<byte>& bytes);
+		static uint8_t getUInt8(const vector<byte>& bytes);
+		static uint16_t getUInt16(const vector<byte>& bytes);
+		static uint32_t getUInt32(const vector<byte>& bytes);
+		static uint64_t getUInt64(const vector<byte>& bytes);
+		// allocation free conversions; the byte order is passed explicitly
+		// and the global endian override is ignored
+		static constexpr void getBytes(bool value, byte* bytes, Endian order);
+		static constexpr void getBytes(char value, byte* bytes, Endian order);
+		static constexpr void getBytes(signed char value, byte* bytes, Endian order);
+		static constexpr void getBytes(unsigned char value, byte* bytes, Endian order);
+		static inline void getBytes(float value, byte* bytes, Endian order);
+		static inline void getBytes(double value, byte* bytes, Endian order);
+		static constexpr void getBytes(int16_t value, byte* bytes, Endian order);
+		static constexpr void getBytes(int32_t value, byte* bytes, Endian order);
+		static constexpr void getBytes(int64_t value, byte* bytes, Endian order);
+		static constexpr void getBytes(uint16_t value, byte* bytes, Endian order);
+		static constexpr void getBytes(uint32_t value, byte* bytes, Endian order);
+		static constexpr void getBytes(uint64_t value, byte* bytes, Endian order);
+		template <typename T>
+		static inline std::array<byte, sizeof(T)> getBytes(T value, Endian order);
+		static constexpr bool getBool(const byte* bytes, Endian order);
+		static constexpr char getChar(const byte* bytes, Endian order);
+		static constexpr signed char getSChar(const byte* bytes, Endian order);
+		static constexpr unsigned char getUChar(const byte* bytes, Endian order);
+		static inline float getFloat(const byte* bytes, Endian order);
+		static inline double getDouble(const byte* bytes, Endian order);
+		static constexpr int8_t getInt8(const byte* bytes, Endian order);
+		static constexpr int16_t getInt16(const byte* bytes, Endian order);
+		static constexpr int32_t getInt32(const byte* bytes, Endian order);
+		static constexpr int64_t getInt64(const byte* bytes, Endian order);
+		static constexpr uint8_t getUInt8(const byte* bytes, Endian order);
+		static constexpr uint16_t getUInt16(const byte* bytes, Endian order);
+		static constexpr uint32_t getUInt32(const byte* bytes, Endian order);
+		static constexpr uint64_t getUInt64(const byte* bytes, Endian order);
 
 	private:
 		// to bytes
@@ -80,43 +173,274 @@ class BitConverter {
 		static vector<byte> getBytes4(uint32_t value);
 		static vector<byte> getBytes8(uint64_t value);
 		// from bytes
-		static uint8_t getValue1(vector<byte> bytes);
-		static uint16_t getValue2(vector<byte> bytes);
-		static uint32_t getValue4(vector<byte> bytes);
-		static uint64_t getValue8(vector<byte> bytes);
+		static uint8_t getValue1(const vector<byte>& bytes);
+		static uint16_t getValue2(const vector<byte>& bytes);
+		static uint32_t getValue4(const vector<byte>& bytes);
+		static uint64_t getValue8(const vector<byte>& bytes);
+		// explicit byte order helpers; spelled out byte by byte so the
+		// compiler folds them into a single load or store plus bswap
+		static constexpr void store2(uint16_t value, byte* bytes, Endian order);
+		static constexpr void store4(uint32_t value, byte* bytes, Endian order);
+		static constexpr void store8(uint64_t value, byte* bytes, Endian order);
+		static constexpr uint16_t load2(const byte* bytes, Endian order);
+		static constexpr uint32_t load4(const byte* bytes, Endian order);
+		static constexpr uint64_t load8(const byte* bytes, Endian order);
 
 		static bool forceEndian;
 		static Endian endianOverride;
 };
 
+constexpr void BitConverter::store2(uint16_t value, byte* bytes, Endian order) {
+	if (order == Little) {
+		bytes[0] = (byte)value;
+		bytes[1] = (byte)(value >> 8);
+	} else {
+		bytes[0] = (byte)(value >> 8);
+		bytes[1] = (byte)value;
+	}
+}
+
+constexpr void BitConverter::store4(uint32_t value, byte* bytes, Endian order) {
+	if (order == Little) {
+		bytes[0] = (byte)value;
+		bytes[1] = (byte)(value >> 8);
+		bytes[2] = (byte)(value >> 16);
+		bytes[3] = (byte)(value >> 24);
+	} else {
+		bytes[0] = (byte)(value >> 24);
+		bytes[1] = (byte)(value >> 16);
+		bytes[2] = (byte)(value >> 8);
+		bytes[3] = (byte)value;
+	}
+}
+
+constexpr void BitConverter::store8(uint64_t value, byte* bytes, Endian order) {
+	if (order == Little) {
+		bytes[0] = (byte)value;
+		bytes[1] = (byte)(value >> 8);
+		bytes[2] = (byte)(value >> 16);
+		bytes[3] = (byte)(value >> 24);
+		bytes[4] = (byte)(value >> 32);
+		bytes[5] = (byte)(value >> 40);
+		bytes[6] = (byte)(value >> 48);
+		bytes[7] = (byte)(value >> 56);
+	} else {
+		bytes[0] = (byte)(value >> 56);
+		bytes[1] = (byte)(value >> 48);
+		bytes[2] = (byte)(value >> 40);
+		bytes[3] = (byte)(value >> 32);
+		bytes[4] = (byte)(value >> 24);
+		bytes[5] = (byte)(value >> 16);
+		bytes[6] = (byte)(value >> 8);
+		bytes[7] = (byte)value;
+	}
+}
+
+constexpr uint16_t BitConverter::load2(const byte* bytes, Endian order) {
+	if (order == Little) {
+		return (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+	return (uint16_t)((bytes[0] << 8) | bytes[1]);
+}
+
+constexpr uint32_t BitConverter::load4(const byte* bytes, Endian order) {
+	if (order == Little) {
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+	return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+constexpr uint64_t BitConverter::load8(const byte* bytes, Endian order) {
+	if (order == Little) {
+		return (uint64_t)bytes[0] | ((uint64_t)bytes[1] << 8) | ((uint64_t)bytes[2] << 16) | ((uint64_t)bytes[3] << 24) |
+			((uint64_t)bytes[4] << 32) | ((uint64_t)bytes[5] << 40) | ((uint64_t)bytes[6] << 48) | ((uint64_t)bytes[7] << 56);
+	}
+	return ((uint64_t)bytes[0] << 56) | ((uint64_t)bytes[1] << 48) | ((uint64_t)bytes[2] << 40) | ((uint64_t)bytes[3] << 32) |
+		((uint64_t)bytes[4] << 24) | ((uint64_t)bytes[5] << 16) | ((uint64_t)bytes[6] << 8) | (uint64_t)bytes[7];
+}
+
+constexpr void BitConverter::getBytes(bool value, byte* bytes, Endian) {
+	bytes[0] = value ? 1 : 0;
+}
+
+constexpr void BitConverter::getBytes(char value, byte* bytes, Endian) {
+	bytes[0] = (byte)value;
+}
+
+constexpr void BitConverter::getBytes(signed char value, byte* bytes, Endian) {
+	bytes[0] = (byte)value;
+}
+
+constexpr void BitConverter::getBytes(unsigned char value, byte* bytes, Endian) {
+	bytes[0] = (byte)value;
+}
+
+inline void BitConverter::getBytes(float value, byte* bytes, Endian order) {
+	uint32_t valueBytes;
+	memcpy(&valueBytes, &value, 4);
+	store4(valueBytes, bytes, order);
+}
+
+inline void BitConverter::getBytes(double value, byte* bytes, Endian order) {
+	uint64_t valueBytes;
+	memcpy(&valueBytes, &value, 8);
+	store8(valueBytes, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(int16_t value, byte* bytes, Endian order) {
+	store2((uint16_t)value, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(int32_t value, byte* bytes, Endian order) {
+	store4((uint32_t)value, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(int64_t value, byte* bytes, Endian order) {
+	store8((uint64_t)value, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(uint16_t value, byte* bytes, Endian order) {
+	store2(value, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(uint32_t value, byte* bytes, Endian order) {
+	store4(value, bytes, order);
+}
+
+constexpr void BitConverter::getBytes(uint64_t value, byte* bytes, Endian order) {
+	store8(value, bytes, order);
+}
+
+template <typename T>
+inline std::array<byte, sizeof(T)> BitConverter::getBytes(T value, Endian order) {
+	std::array<byte, sizeof(T)> bytes = { };
+	getBytes(value, bytes.data(), order);
+	return bytes;
+}
+
+constexpr bool BitConverter::getBool(const byte* bytes, Endian) {
+	return (bytes[0] != 0);
+}
+
+constexpr char BitConverter::getChar(const byte* bytes, Endian) {
+	return (char)bytes[0];
+}
+
+constexpr signed char BitConverter::getSChar(const byte* bytes, Endian) {
+	return (signed char)bytes[0];
+}
+
+constexpr unsigned char BitConverter::getUChar(const byte* bytes, Endian) {
+	return (unsigned char)bytes[0];
+}
+
+inline float BitConverter::getFloat(const byte* bytes, Endian order) {
+	float value;
+	uint32_t valueBytes = load4(bytes, order);
+	memcpy(&value, &valueBytes, 4);
+	return value;
+}
+
+inline double BitConverter::getDouble(const byte* bytes, Endian order) {
+	double value;
+	uint64_t valueBytes = load8(bytes, order);
+	memcpy(&value, &valueBytes, 8);
+	return value;
+}
+
+constexpr int8_t BitConverter::getInt8(const byte* bytes, Endian) {
+	return (int8_t)bytes[0];
+}
+
+constexpr int16_t BitConverter::getInt16(const byte* bytes, Endian order) {
+	return (int16_t)load2(bytes, order);
+}
+
+constexpr int32_t BitConverter::getInt32(const byte* bytes, Endian order) {
+	return (int32_t)load4(bytes, order);
+}
+
+constexpr int64_t BitConverter::getInt64(const byte* bytes, Endian order) {
+	return (int64_t)load8(bytes, order);
+}
+
+constexpr uint8_t BitConverter::getUInt8(const byte* bytes, Endian) {
+	return bytes[0];
+}
+
+constexpr uint16_t BitConverter::getUInt16(const byte* bytes, Endian order) {
+	return load2(bytes, order);
+}
+
+constexpr uint32_t BitConverter::getUInt32(const byte* bytes, Endian order) {
+	return load4(bytes, order);
+}
+
+constexpr uint64_t BitConverter::getUInt64(const byte* bytes, Endian order) {
+	return load8(bytes, order);
+}
+
+class AsyncFlusher;
+class BinaryIOStream;
+
 class BinaryIOBase {
 	public:
-		BinaryIOBase(string fileLocation, ios::openmode mode);
+		static const int DEFAULT_BUFFERSIZE = 16384;
+		static const int MIN_BUFFERSIZE = 16;
+		// bufferAlignment must be zero or a power of two
+		BinaryIOBase(string fileLocation, ios::openmode mode, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		// takes ownership of stream, which is opened here
+		BinaryIOBase(BinaryIOStream* stream, string fileLocation, ios::openmode mode, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0);
 		~BinaryIOBase();
+		// owns the buffer and the stream
+		BinaryIOBase(const BinaryIOBase&) = delete;
+		BinaryIOBase& operator=(const BinaryIOBase&) = delete;
 		bool hasError();
 		BinaryIOError getError();
 		void forceSetEndian(Endian endian);
 		void forceUnsetEndian();
+		int getBufferSize();
+		// access to the storage backend for OS level tuning
+		BinaryIOStream* getStream();
+		// doubles the buffer, up to maxBufferSize, after a run of full
+		// sequential refills or flushes
+		void enableAdaptiveBuffer(int maxBufferSize);
+		void disableAdaptiveBuffer();
+		// snapshot of this instance's counters
+		BinaryIOStats getStats();
+		void resetStats();
+		// totals over every reader and writer destroyed so far; counters
+		// are folded in once, from the destructor, so the hot paths never
+		// touch shared memory
+		static BinaryIOStats getGlobalStats();
+		static void resetGlobalStats();
 
 	protected:
 		bool isLittleEndian();
+		bool needsByteSwap();
+		void adaptBuffer(bool fullChunk);
+		BinaryIOStats stats;
 		ios::openmode mode;
 		string fileLocation;
-		fstream stream;
-		static const int BUFFERMAX = 16384;
+		BinaryIOStream* stream;
+		int bufferSize, bufferAlignment;
 		int bufferPos = 0, bufferDataSize = 0;
-		char buffer[BUFFERMAX] = { };
+		char* buffer;
 		BinaryIOError lastError;
 
 	private:
+		void allocateBuffer(int size);
+		static const int ADAPTIVE_RUNLENGTH = 4;
 		bool forceEndian;
 		Endian endianOverride;
+		int adaptiveMaxSize, sequentialChunks;
 };
 
 class BinaryReader : public BinaryIOBase {
 	public:
-		BinaryReader(const char* fileLocation);
-		BinaryReader(string fileLocation);
+		BinaryReader(const char* fileLocation, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		BinaryReader(string fileLocation, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		BinaryReader(BinaryIOStream* stream, string fileLocation, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0);
 		~BinaryReader();
 		bool moreData();
 		bool readBool();
@@ -135,19 +459,82 @@ class BinaryReader : public BinaryIOBase {
 		uint32_t readUInt32();
 		uint64_t readUInt64();
 		vector<byte> readBytes(int count);
+		// view into the internal buffer, valid until the next read; counts
+		// larger than the buffer return an empty view and consume nothing
+		ByteView readBytesView(int count);
+		// copy into caller owned memory without per byte overhead
+		int readInto(byte* bytes, int count);
+		void readInto(vector<byte>& bytes, int count);
+		// bulk reads; values are byte swapped in place when the file byte
+		// order differs from the host
+		void readArray(float* values, int count);
+		void readArray(double* values, int count);
+		void readArray(int8_t* values, int count);
+		void readArray(int16_t* values, int count);
+		void readArray(int32_t* values, int count);
+		void readArray(int64_t* values, int count);
+		void readArray(uint8_t* values, int count);
+		void readArray(uint16_t* values, int count);
+		void readArray(uint32_t* values, int count);
+		void readArray(uint64_t* values, int count);
+		// LEB128 varints; readVarInt undoes the zigzag mapping. Malformed
+		// values set InvalidData
+		uint64_t readVarUInt();
+		int64_t readVarInt();
+		// Stream VByte blocks written by writeVarUIntArray/writeVarIntArray;
+		// count must match the count that was written
+		void readVarUIntArray(uint32_t* values, int count);
+		void readVarIntArray(int32_t* values, int count);
+		// length prefixed strings. The view points into the read buffer, or
+		// into a scratch string for strings larger than it, and is valid
+		// until the next readStringView or read
+		std::string_view readStringView(StringPrefix prefix = VarintPrefix);
+		// reuses the capacity of value
+		void readString(string& value, StringPrefix prefix = VarintPrefix);
+		string readString(StringPrefix prefix = VarintPrefix);
+		// records described with BINARYIO_RECORD; defined in RecordLayout.h
+		template <typename T>
+		void readRecord(T& record);
+		template <typename T>
+		void readRecords(T* records, int count);
+		// file offset of the next byte to be read
+		uint64_t tell();
+		// a target inside the buffered window only moves the read position;
+		// anything else repositions the stream and drops the buffer. A
+		// successful seek clears NotEnoughData
+		bool seek(uint64_t offset);
+		bool skip(uint64_t count);
+		// positional read that leaves the read position alone; returns the
+		// number of bytes copied, short only at the end of the file
+		int readAt(uint64_t offset, byte* bytes, int count);
+
+	protected:
+		size_t readRaw(void* dst, size_t count);
+		bool ensureBuffered(int count);
+		void readNextChunk();
 
 	private:
 		uint8_t read1();
 		uint16_t read2();
 		uint32_t read4();
 		uint64_t read8();
-		void readNextChunk();
+		// varint decode without touching the value counters
+		uint64_t readVarN();
+		void readArrayN(void* values, int count, int size);
+		int readChunk(char* dst, int count);
+		bool endOfFile;
+		// file offset just past the last byte handed over by the stream;
+		// the buffer holds the bufferDataSize bytes in front of it
+		uint64_t streamOffset;
+		int readStringLength(StringPrefix prefix);
+		string stringScratch;
 };
 
 class BinaryWriter : public BinaryIOBase {
 	public:
-		BinaryWriter(const char* fileLocation, bool overwrite = false);
-		BinaryWriter(string fileLocation, bool overwrite = false);
+		BinaryWriter(const char* fileLocation, bool overwrite = false, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		BinaryWriter(string fileLocation, bool overwrite = false, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		BinaryWriter(BinaryIOStream* stream, string fileLocation, bool overwrite = false, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0);
 		~BinaryWriter();
 		void write(bool value);
 		// void write(byte value);
@@ -164,15 +551,60 @@ class BinaryWriter : public BinaryIOBase {
 		void write(uint16_t value);
 		void write(uint32_t value);
 		void write(uint64_t value);
-		void write(vector<byte> bytes);
-		void write(vector<byte> bytes, int start, int count);
+		void write(const vector<byte>& bytes);
+		void write(const vector<byte>& bytes, int start, int count);
+		// bulk writes; values are byte swapped while being copied into the
+		// buffer when the file byte order differs from the host
+		void writeArray(const float* values, int count);
+		void writeArray(const double* values, int count);
+		void writeArray(const int8_t* values, int count);
+		void writeArray(const int16_t* values, int count);
+		void writeArray(const int32_t* values, int count);
+		void writeArray(const int64_t* values, int count);
+		void writeArray(const uint8_t* values, int count);
+		void writeArray(const uint16_t* values, int count);
+		void writeArray(const uint32_t* values, int count);
+		void writeArray(const uint64_t* values, int count);
+		// LEB128 varints, 1 to 10 bytes; writeVarInt zigzag maps the value
+		// first so small negative numbers stay small
+		void writeVarUInt(uint64_t value);
+		void writeVarInt(int64_t value);
+		// Stream VByte block of count values; the count itself is not stored
+		void writeVarUIntArray(const uint32_t* values, int count);
+		void writeVarIntArray(const int32_t* values, int count);
+		// strings too long for a fixed width prefix set InvalidData
+		void writeString(std::string_view value, StringPrefix prefix = VarintPrefix);
+		// records described with BINARYIO_RECORD; defined in RecordLayout.h
+		template <typename T>
+		void writeRecord(const T& record);
+		template <typename T>
+		void writeRecords(const T* records, int count);
+		// hand full buffers to a background thread; at most bufferCount
+		// buffers are in flight and adaptive sizing is turned off
+		void enableAsyncFlush(int bufferCount = 4);
+		void disableAsyncFlush();
+		// waits until everything written so far has reached the stream;
+		// errors from the background thread surface here and on later flushes
+		void sync();
+		// bytes written through this writer, buffered ones included; the
+		// file offset of the next byte for files opened with overwrite
+		uint64_t tell();
+
+	protected:
+		void flush();
 
 	private:
 		void write1(uint8_t value);
 		void write2(uint16_t value);
 		void write4(uint32_t value);
 		void write8(uint64_t value);
-		void flush();
+		// varint encode without touching the value counters
+		void writeVarN(uint64_t value);
+		void writeArrayN(const void* values, int count, int size);
+		void writeRaw(const void* src, size_t count);
+		void writeChunk(const char* src, size_t count);
+		AsyncFlusher* flusher;
+		uint64_t streamOffset;
 };
 
 #endif // __BINARYIO_H__
@@ -0,0 +1,266 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BinaryIO.h"
+
+// Throughput benchmarks. Results go to stdout as CSV, one row per run:
+//
+//     benchmark,order,size,chunk,seconds,mb_per_s
+//
+// order is little, big or native (for baselines), size is the number of
+// payload bytes moved, and chunk is the transfer size for bulk benchmarks
+// (0 otherwise). Usage:
+//
+//     BinaryIOBenchmark [sizes] [directory]
+//
+// sizes is a comma separated list with optional K, M or G suffixes and
+// defaults to 64K,16M,256M; directory defaults to the current one.
+
+#define BENCHMARK_FILE "BinaryIOBenchmark.bin"
+#define BITCONVERTER_SIZE (16 << 20)
+
+using std::chrono::steady_clock;
+
+static const int bulkChunks[] = { 16, 256, 4096, 65536 };
+
+// keeps the optimizer from dropping results nobody looks at
+static volatile uint64_t sink;
+
+// forces bytes through memory so a conversion pair cannot fold away
+static inline void clobber(void* bytes) {
+	asm volatile("" : : "g"(bytes) : "memory");
+}
+
+static double secondsSince(steady_clock::time_point start) {
+	return std::chrono::duration<double>(steady_clock::now() - start).count();
+}
+
+static void report(const char* benchmark, const char* order, uint64_t size, int chunk, double seconds) {
+	double rate = (seconds > 0) ? (size / 1048576.0) / seconds : 0;
+	printf("%s,%s,%llu,%i,%.6f,%.1f\n", benchmark, order, (unsigned long long)size, chunk, seconds, rate);
+	fflush(stdout);
+}
+
+static const char* orderName(Endian order) {
+	return (order == Little) ? "little" : "big";
+}
+
+static uint64_t parseSize(const string& text) {
+	uint64_t value = strtoull(text.c_str(), NULL, 10);
+	switch (text.empty() ? 0 : text[text.size() - 1]) {
+		case 'K':
+		case 'k':
+			return value << 10;
+		case 'M':
+		case 'm':
+			return value << 20;
+		case 'G':
+		case 'g':
+			return value << 30;
+		default:
+			return value;
+	}
+}
+
+static vector<uint64_t> parseSizes(const char* list) {
+	vector<uint64_t> sizes;
+	string text = list;
+	size_t start = 0;
+	while (start <= text.size()) {
+		size_t end = text.find(',', start);
+		if (end == string::npos) {
+			end = text.size();
+		}
+		uint64_t size = parseSize(text.substr(start, end - start));
+		if (size > 0) {
+			sizes.push_back(size);
+		}
+		start = end + 1;
+	}
+	return sizes;
+}
+
+// Baselines: what the hardware and libc manage without the library.
+static void benchmarkBaselines(const string& file, uint64_t size) {
+	vector<char> data(std::min(size, (uint64_t)BinaryIOBase::DEFAULT_BUFFERSIZE), 'x');
+
+	steady_clock::time_point start = steady_clock::now();
+	FILE* out = fopen(file.c_str(), "wb");
+	if (out != NULL) {
+		for (uint64_t done = 0; done < size; done += data.size()) {
+			fwrite(data.data(), 1, std::min((uint64_t)data.size(), size - done), out);
+		}
+		fclose(out);
+		report("fwrite", "native", size, (int)data.size(), secondsSince(start));
+	} else {
+		fprintf(stderr, "fwrite: cannot open %s, skipped\n", file.c_str());
+	}
+
+	start = steady_clock::now();
+	FILE* in = fopen(file.c_str(), "rb");
+	if (in != NULL) {
+		uint64_t total = 0;
+		size_t got;
+		while ((got = fread(data.data(), 1, data.size(), in)) > 0) {
+			total += got;
+		}
+		fclose(in);
+		sink = total;
+		report("fread", "native", size, (int)data.size(), secondsSince(start));
+	} else {
+		fprintf(stderr, "fread: cannot open %s, skipped\n", file.c_str());
+	}
+
+	vector<char> source(std::min(size, (uint64_t)(64 << 20)), 'y');
+	vector<char> target(source.size());
+	start = steady_clock::now();
+	for (uint64_t done = 0; done < size; done += source.size()) {
+		size_t chunk = (size_t)std::min((uint64_t)source.size(), size - done);
+		memcpy(target.data(), source.data(), chunk);
+		sink = target[chunk - 1];
+	}
+	report("memcpy", "native", size, 0, secondsSince(start));
+}
+
+// One writer and one reader pass over size bytes of T through the scalar
+// overloads.
+template <typename T>
+static void benchmarkValues(const string& file, uint64_t size, Endian order, const char* name, T (BinaryReader::*read)()) {
+	uint64_t count = size / sizeof(T);
+	string writeName = string("write_") + name;
+	string readName = string("read_") + name;
+
+	steady_clock::time_point start = steady_clock::now();
+	{
+		BinaryWriter bw(file, true);
+		bw.forceSetEndian(order);
+		for (uint64_t i = 0; i < count; i++) {
+			bw.write((T)i);
+		}
+	}
+	report(writeName.c_str(), orderName(order), count * sizeof(T), 0, secondsSince(start));
+
+	start = steady_clock::now();
+	{
+		BinaryReader br(file);
+		br.forceSetEndian(order);
+		uint64_t total = 0;
+		for (uint64_t i = 0; i < count; i++) {
+			total += (uint64_t)(br.*read)();
+		}
+		sink = total;
+	}
+	report(readName.c_str(), orderName(order), count * sizeof(T), 0, secondsSince(start));
+}
+
+static void benchmarkAllValues(const string& file, uint64_t size, Endian order) {
+	benchmarkValues<bool>(file, size, order, "bool", &BinaryReader::readBool);
+	benchmarkValues<char>(file, size, order, "char", &BinaryReader::readChar);
+	benchmarkValues<signed char>(file, size, order, "schar", &BinaryReader::readSChar);
+	benchmarkValues<unsigned char>(file, size, order, "uchar", &BinaryReader::readUChar);
+	benchmarkValues<float>(file, size, order, "float", &BinaryReader::readFloat);
+	benchmarkValues<double>(file, size, order, "double", &BinaryReader::readDouble);
+	benchmarkValues<int8_t>(file, size, order, "int8", &BinaryReader::readInt8);
+	benchmarkValues<int16_t>(file, size, order, "int16", &BinaryReader::readInt16);
+	benchmarkValues<int32_t>(file, size, order, "int32", &BinaryReader::readInt32);
+	benchmarkValues<int64_t>(file, size, order, "int64", &BinaryReader::readInt64);
+	benchmarkValues<uint8_t>(file, size, order, "uint8", &BinaryReader::readUInt8);
+	benchmarkValues<uint16_t>(file, size, order, "uint16", &BinaryReader::readUInt16);
+	benchmarkValues<uint32_t>(file, size, order, "uint32", &BinaryReader::readUInt32);
+	benchmarkValues<uint64_t>(file, size, order, "uint64", &BinaryReader::readUInt64);
+}
+
+// write(vector<byte>) and readBytes at several transfer sizes.
+static void benchmarkBytes(const string& file, uint64_t size) {
+	for (int chunk : bulkChunks) {
+		uint64_t count = size / chunk;
+		vector<byte> bytes(chunk, 0x5A);
+
+		steady_clock::time_point start = steady_clock::now();
+		{
+			BinaryWriter bw(file, true);
+			for (uint64_t i = 0; i < count; i++) {
+				bw.write(bytes);
+			}
+		}
+		report("write_bytes", "native", count * chunk, chunk, secondsSince(start));
+
+		start = steady_clock::now();
+		{
+			BinaryReader br(file);
+			uint64_t total = 0;
+			for (uint64_t i = 0; i < count; i++) {
+				total += br.readBytes(chunk).size();
+			}
+			sink = total;
+		}
+		report("read_bytes", "native", count * chunk, chunk, secondsSince(start));
+	}
+}
+
+// getBytes(T) followed by the matching getXxx, both the vector and the
+// caller buffer forms; nothing touches the disk.
+template <typename T>
+static void benchmarkConverter(Endian order, const char* name, T (*getVector)(const vector<byte>&), T (*getBuffer)(const byte*, Endian)) {
+	uint64_t count = BITCONVERTER_SIZE / sizeof(T);
+	string vectorName = string("bitconverter_") + name;
+	string bufferName = string("bitconverter_buffer_") + name;
+
+	BitConverter::forceSetEndian(order);
+	steady_clock::time_point start = steady_clock::now();
+	uint64_t total = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		total += (uint64_t)getVector(BitConverter::getBytes((T)i));
+	}
+	sink = total;
+	report(vectorName.c_str(), orderName(order), count * sizeof(T), 0, secondsSince(start));
+	BitConverter::forceUnsetEndian();
+
+	start = steady_clock::now();
+	byte bytes[sizeof(T)];
+	total = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		BitConverter::getBytes((T)i, bytes, order);
+		clobber(bytes);
+		total += (uint64_t)getBuffer(bytes, order);
+	}
+	sink = total;
+	report(bufferName.c_str(), orderName(order), count * sizeof(T), 0, secondsSince(start));
+}
+
+static void benchmarkAllConverters(Endian order) {
+	benchmarkConverter<bool>(order, "bool", &BitConverter::getBool, &BitConverter::getBool);
+	benchmarkConverter<char>(order, "char", &BitConverter::getChar, &BitConverter::getChar);
+	benchmarkConverter<signed char>(order, "schar", &BitConverter::getSChar, &BitConverter::getSChar);
+	benchmarkConverter<unsigned char>(order, "uchar", &BitConverter::getUChar, &BitConverter::getUChar);
+	benchmarkConverter<float>(order, "float", &BitConverter::getFloat, &BitConverter::getFloat);
+	benchmarkConverter<double>(order, "double", &BitConverter::getDouble, &BitConverter::getDouble);
+	benchmarkConverter<int16_t>(order, "int16", &BitConverter::getInt16, &BitConverter::getInt16);
+	benchmarkConverter<int32_t>(order, "int32", &BitConverter::getInt32, &BitConverter::getInt32);
+	benchmarkConverter<int64_t>(order, "int64", &BitConverter::getInt64, &BitConverter::getInt64);
+	benchmarkConverter<uint16_t>(order, "uint16", &BitConverter::getUInt16, &BitConverter::getUInt16);
+	benchmarkConverter<uint32_t>(order, "uint32", &BitConverter::getUInt32, &BitConverter::getUInt32);
+	benchmarkConverter<uint64_t>(order, "uint64", &BitConverter::getUInt64, &BitConverter::getUInt64);
+}
+
+int main(int argc, char** argv) {
+	vector<uint64_t> sizes = parseSizes((argc > 1) ? argv[1] : "64K,16M,256M");
+	string file = string((argc > 2) ? argv[2] : ".") + "/" + BENCHMARK_FILE;
+
+	printf("benchmark,order,size,chunk,seconds,mb_per_s\n");
+	for (uint64_t size : sizes) {
+		fprintf(stderr, "size %llu\n", (unsigned long long)size);
+		benchmarkBaselines(file, size);
+		benchmarkAllValues(file, size, Little);
+		benchmarkAllValues(file, size, Big);
+		benchmarkBytes(file, size);
+	}
+	benchmarkAllConverters(Little);
+	benchmarkAllConverters(Big);
+
+	remove(file.c_str());
+	return 0;
+}
@@ -0,0 +1,295 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinaryIOStream.h"
+#include "IoUringStream.h"
+
+BinaryIOStream::~BinaryIOStream() {
+
+}
+
+bool BinaryIOStream::sync() {
+	return true;
+}
+
+bool BinaryIOStream::advise(BinaryIOAdvice, uint64_t, uint64_t) {
+	return false;
+}
+
+bool BinaryIOStream::allocate(uint64_t, uint64_t) {
+	return false;
+}
+
+BinaryIOError BinaryIOStream::getError() {
+	return None;
+}
+
+BinaryIOStream* BinaryIOStream::create(BinaryIOBackend backend) {
+	switch (backend) {
+		case FstreamBackend:
+			return new FstreamStream();
+		case IoUringBackend:
+			return new IoUringStream();
+		case PosixBackend:
+		case DefaultBackend:
+		default:
+			return new PosixStream();
+	}
+}
+
+PosixStream::PosixStream() {
+	fd = -1;
+}
+
+PosixStream::~PosixStream() {
+	close();
+}
+
+BinaryIOError PosixStream::open(const string& fileLocation, ios::openmode mode) {
+	int flags = O_CLOEXEC;
+	if ((mode & ios::in) && (mode & ios::out)) {
+		flags |= O_RDWR;
+	} else if (mode & ios::out) {
+		flags |= O_WRONLY;
+	} else {
+		flags |= O_RDONLY;
+	}
+	if (mode & ios::out) {
+		flags |= O_CREAT;
+	}
+	if (mode & ios::trunc) {
+		flags |= O_TRUNC;
+	}
+	if (mode & ios::app) {
+		flags |= O_APPEND;
+	}
+
+	fd = ::open(fileLocation.c_str(), flags, 0666);
+	if (fd < 0) {
+		return (errno == ENOENT) ? FileDoesNotExist : CannotOpenFile;
+	}
+
+	return None;
+}
+
+void PosixStream::close() {
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+}
+
+bool PosixStream::isOpen() {
+	return (fd >= 0);
+}
+
+int64_t PosixStream::read(char* dst, size_t count) {
+	ssize_t ret;
+	do {
+		ret = ::read(fd, dst, count);
+	} while ((ret < 0) && (errno == EINTR));
+
+	return ret;
+}
+
+int64_t PosixStream::write(const char* src, size_t count) {
+	size_t written = 0;
+	while (written < count) {
+		ssize_t ret = ::write(fd, src + written, count - written);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		written += ret;
+	}
+
+	return written;
+}
+
+int64_t PosixStream::readAt(char* dst, size_t count, uint64_t offset) {
+	ssize_t ret;
+	do {
+		ret = ::pread(fd, dst, count, offset);
+	} while ((ret < 0) && (errno == EINTR));
+
+	return ret;
+}
+
+int64_t PosixStream::writeAt(const char* src, size_t count, uint64_t offset) {
+	size_t written = 0;
+	while (written < count) {
+		ssize_t ret = ::pwrite(fd, src + written, count - written, offset + written);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		written += ret;
+	}
+
+	return written;
+}
+
+bool PosixStream::seek(uint64_t offset) {
+	return (lseek(fd, offset, SEEK_SET) >= 0);
+}
+
+int64_t PosixStream::tell() {
+	return lseek(fd, 0, SEEK_CUR);
+}
+
+int64_t PosixStream::size() {
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		return -1;
+	}
+
+	return info.st_size;
+}
+
+bool PosixStream::sync() {
+	return (fdatasync(fd) == 0);
+}
+
+bool PosixStream::advise(BinaryIOAdvice advice, uint64_t offset, uint64_t length) {
+	int posixAdvice;
+	switch (advice) {
+		case AdviseSequential:
+			posixAdvice = POSIX_FADV_SEQUENTIAL;
+			break;
+		case AdviseRandom:
+			posixAdvice = POSIX_FADV_RANDOM;
+			break;
+		case AdviseWillNeed:
+			posixAdvice = POSIX_FADV_WILLNEED;
+			break;
+		case AdviseDontNeed:
+			posixAdvice = POSIX_FADV_DONTNEED;
+			break;
+		case AdviseNormal:
+		default:
+			posixAdvice = POSIX_FADV_NORMAL;
+			break;
+	}
+
+	return (posix_fadvise(fd, offset, length, posixAdvice) == 0);
+}
+
+bool PosixStream::allocate(uint64_t offset, uint64_t length) {
+	return (posix_fallocate(fd, offset, length) == 0);
+}
+
+int PosixStream::getDescriptor() {
+	return fd;
+}
+
+FstreamStream::~FstreamStream() {
+	close();
+}
+
+BinaryIOError FstreamStream::open(const string& fileLocation, ios::openmode mode) {
+	this->mode = mode;
+	stream.open(fileLocation, mode);
+	if (!stream.is_open()) {
+		return CannotOpenFile;
+	}
+
+	return None;
+}
+
+void FstreamStream::close() {
+	if (stream.is_open()) {
+		stream.close();
+	}
+}
+
+bool FstreamStream::isOpen() {
+	return stream.is_open();
+}
+
+int64_t FstreamStream::read(char* dst, size_t count) {
+	stream.read(dst, count);
+	if (stream.bad()) {
+		return -1;
+	}
+
+	int64_t ret = stream.gcount();
+	if (stream.eof()) {
+		// a short read sets eof and fail; clear them so later calls work
+		stream.clear();
+	}
+	return ret;
+}
+
+int64_t FstreamStream::write(const char* src, size_t count) {
+	stream.write(src, count);
+	if (stream.fail() || stream.bad()) {
+		return -1;
+	}
+
+	return count;
+}
+
+int64_t FstreamStream::readAt(char* dst, size_t count, uint64_t offset) {
+	int64_t position = tell();
+	if ((position < 0) || !seek(offset)) {
+		return -1;
+	}
+
+	int64_t ret = read(dst, count);
+	seek(position);
+	return ret;
+}
+
+int64_t FstreamStream::writeAt(const char* src, size_t count, uint64_t offset) {
+	int64_t position = tell();
+	if ((position < 0) || !seek(offset)) {
+		return -1;
+	}
+
+	int64_t ret = write(src, count);
+	seek(position);
+	return ret;
+}
+
+bool FstreamStream::seek(uint64_t offset) {
+	if (mode & ios::in) {
+		stream.seekg(offset);
+	}
+	if (mode & ios::out) {
+		stream.seekp(offset);
+	}
+
+	return !stream.fail();
+}
+
+int64_t FstreamStream::tell() {
+	if (mode & ios::in) {
+		return stream.tellg();
+	}
+
+	return stream.tellp();
+}
+
+int64_t FstreamStream::size() {
+	int64_t position = tell();
+	if (mode & ios::in) {
+		stream.seekg(0, ios::end);
+	} else {
+		stream.seekp(0, ios::end);
+	}
+
+	int64_t end = tell();
+	seek(position);
+	return end;
+}
+
+bool FstreamStream::sync() {
+	stream.flush();
+	return !stream.fail();
+}
@@ -0,0 +1,87 @@
+#ifndef __BINARYIOSTREAM_H__
+#define __BINARYIOSTREAM_H__
+
+#include "BinaryIO.h"
+
+enum BinaryIOAdvice {
+	AdviseNormal,
+	AdviseSequential,
+	AdviseRandom,
+	AdviseWillNeed,
+	AdviseDontNeed,
+};
+
+// Storage layer underneath BinaryReader and BinaryWriter. read() and
+// write() move bytes at the current position; readAt() and writeAt() are
+// positional and leave the current position untouched. Transfer functions
+// return the number of bytes moved, 0 at end of file, or -1 on error.
+class BinaryIOStream {
+	public:
+		virtual ~BinaryIOStream();
+		virtual BinaryIOError open(const string& fileLocation, ios::openmode mode) = 0;
+		virtual void close() = 0;
+		virtual bool isOpen() = 0;
+		virtual int64_t read(char* dst, size_t count) = 0;
+		virtual int64_t write(const char* src, size_t count) = 0;
+		virtual int64_t readAt(char* dst, size_t count, uint64_t offset) = 0;
+		virtual int64_t writeAt(const char* src, size_t count, uint64_t offset) = 0;
+		virtual bool seek(uint64_t offset) = 0;
+		virtual int64_t tell() = 0;
+		virtual int64_t size() = 0;
+		virtual bool sync();
+		// OS tuning hooks; backends without support report false
+		virtual bool advise(BinaryIOAdvice advice, uint64_t offset = 0, uint64_t length = 0);
+		virtual bool allocate(uint64_t offset, uint64_t length);
+		// cause of the last failed transfer for backends that know more than
+		// a plain read or write error; None otherwise
+		virtual BinaryIOError getError();
+
+		static BinaryIOStream* create(BinaryIOBackend backend);
+};
+
+// Native file descriptor backend; one plain syscall per transfer.
+class PosixStream : public BinaryIOStream {
+	public:
+		PosixStream();
+		~PosixStream();
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		bool sync();
+		bool advise(BinaryIOAdvice advice, uint64_t offset = 0, uint64_t length = 0);
+		bool allocate(uint64_t offset, uint64_t length);
+		int getDescriptor();
+
+	protected:
+		int fd;
+};
+
+// Portable fallback built on std::fstream.
+class FstreamStream : public BinaryIOStream {
+	public:
+		~FstreamStream();
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		bool sync();
+
+	private:
+		fstream stream;
+		ios::openmode mode;
+};
+
+#endif // __BINARYIOSTREAM_H__
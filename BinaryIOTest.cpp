@@ -1,9 +1,22 @@
 #include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 #include "BinaryIO.h"
+#include "BinaryLog.h"
+#include "ChecksumStream.h"
+#include "ColumnarBinaryIO.h"
+#include "CompressedStream.h"
+#include "Crc32c.h"
+#include "EndianBinaryIO.h"
+#include "IoUringStream.h"
 #include "Logger.h"
+#include "MappedBinaryReader.h"
+#include "ParallelBinaryReader.h"
+#include "RecordLayout.h"
+#include "SharedAppendWriter.h"
+#include "SyncMarker.h"
 
 using std::ifstream;
 using std::ofstream;
@@ -15,9 +28,73 @@ using std::ofstream;
 // Big endian files
 #define TEST_WRITEBE "TestWriteBE.bin"
 #define TEST_STATICBE "TestStaticBE.bin"
+// Compile time endian files
+#define TEST_FIXEDWRITELE "TestFixedWriteLE.bin"
+#define TEST_FIXEDWRITEBE "TestFixedWriteBE.bin"
+// Storage backend files
+#define TEST_FSTREAMWRITE "TestFstreamWrite.bin"
+#define TEST_MISSING "TestMissing.bin"
+#define TEST_IOURING "TestIoUring.bin"
+// Bulk array files
+#define TEST_ARRAYLE "TestArrayLE.bin"
+#define TEST_ARRAYBE "TestArrayBE.bin"
+// Raw byte files
+#define TEST_BYTES "TestBytes.bin"
+// Buffer sizing files
+#define TEST_SMALLBUFFER "TestSmallBuffer.bin"
+#define TEST_ADAPTIVE "TestAdaptive.bin"
+#define TEST_ASYNC "TestAsync.bin"
+// Random access files
+#define TEST_SEEK "TestSeek.bin"
+#define TEST_PARALLEL "TestParallel.bin"
+// Variable length integer files
+#define TEST_VARINT "TestVarint.bin"
+// String files
+#define TEST_STRINGS "TestStrings.bin"
+// Record layout files
+#define TEST_RECORDS "TestRecords.bin"
+#define TEST_RECORDFIELDS "TestRecordFields.bin"
+// Columnar files
+#define TEST_COLUMNAR "TestColumnar.bin"
+// Compressed files
+#define TEST_COMPRESSED "TestCompressed.bin"
+#define TEST_COMPRESSEDCORRUPT "TestCompressedCorrupt.bin"
+// Checksummed files
+#define TEST_CHECKSUM "TestChecksum.bin"
+// I/O statistics
+#define TEST_STATS "TestStats.bin"
+// Binary log
+#define TEST_BINARYLOG "TestBinaryLog.bin"
+#define TEST_BINARYLOGSPARSE "TestBinaryLogSparse.bin"
+// Shared appends
+#define TEST_SHAREDAPPEND "TestSharedAppend.bin"
+// Sync markers
+#define TEST_SYNCMARKER "TestSyncMarker.bin"
 
 #define TEST_VALUECOUNT 29
 #define TEST_BYTECOUNT 93
+#define TEST_ARRAYCOUNT 10000
+#define TEST_RAWBYTECOUNT 50000
+#define TEST_ADAPTIVECOUNT (1 << 20)
+#define TEST_IOURINGCOUNT 300000
+#define TEST_ASYNCCOUNT 200000
+#define TEST_SEEKCOUNT 20000
+#define TEST_PARALLELCOUNT 100003
+#define TEST_VARINTCOUNT 10001
+#define TEST_RECORDCOUNT 1000
+#define TEST_COLUMNARROWS 10000
+#define TEST_COMPRESSEDCOUNT 100000
+#define TEST_CHECKSUMCOUNT 20000
+#define TEST_STATSCOUNT 5000
+#define TEST_ASYNCLOGTHREADS 4
+#define TEST_ASYNCLOGCOUNT 5000
+#define TEST_ASYNCLOGDROPCOUNT 100
+#define TEST_ASYNCLOGBURSTCOUNT 10000
+#define TEST_LOGTIMECOUNT 200000
+#define TEST_BINARYLOGCOUNT 1000
+#define TEST_SHAREDAPPENDTHREADS 8
+#define TEST_SHAREDAPPENDCOUNT 20000
+#define TEST_SYNCMARKERCOUNT 30000
 
 enum TestValueType {
 	Bool,
@@ -220,6 +297,26 @@ static const vector<byte> bigEndianVectors[TEST_VALUECOUNT] = {
 	{ (byte)0x81, (byte)0x82, (byte)0x83, (byte)0x84, (byte)0x85, (byte)0x86, (byte)0x87, (byte)0x88,  },
 };
 
+// wire layout matches memory layout, so unswapped batches are one memcpy
+struct TestTelemetry {
+	uint32_t id;
+	uint16_t flags;
+	uint8_t kind;
+	int8_t level;
+	double value;
+	float axis[4];
+	int64_t time;
+};
+BINARYIO_RECORD(TestTelemetry, &TestTelemetry::id, &TestTelemetry::flags, &TestTelemetry::kind, &TestTelemetry::level, &TestTelemetry::value, &TestTelemetry::axis, &TestTelemetry::time)
+
+// padded in memory and listed out of declaration order on the wire
+struct TestSample {
+	uint8_t tag;
+	uint32_t count;
+	double value;
+};
+BINARYIO_RECORD(TestSample, &TestSample::value, &TestSample::tag, &TestSample::count)
+
 // helpers
 string bytesToString(const vector<byte>& bytes);
 bool compareFiles(const char* testFile, const char* staticFile);
@@ -230,12 +327,49 @@ void writeTestStaticFiles();
 bool testBitConverterLittleEndian();
 bool testBitConverterBigEndian();
 bool testBitConverter(Endian endian, const vector<byte>* staticBytes);
+bool testBitConverterBufferLittleEndian();
+bool testBitConverterBufferBigEndian();
+bool testBitConverterBuffer(Endian endian, const vector<byte>* staticBytes);
 bool testReadLittleEndian();
 bool testReadBigEndian();
-bool testRead(BinaryReader& br);
+template <typename Reader>
+bool testRead(Reader& br);
 bool testWriteLittleEndian();
 bool testWriteBigEndian();
-bool testWrite(BinaryWriter& bw);
+template <typename Writer>
+bool testWrite(Writer& bw);
+bool testFixedEndianRead();
+bool testFixedEndianWrite();
+bool testFstreamBackend();
+bool testMissingFile();
+bool testIoUringBackend();
+bool testArrayLittleEndian();
+bool testArrayBigEndian();
+bool testArray(Endian endian, const char* fileName);
+bool testReadBytes();
+bool testSmallBuffer();
+bool testAdaptiveBuffer();
+bool testAsyncFlush();
+bool testSeek();
+bool testParallelRead();
+bool testVarint();
+bool testVarint(int bufferSize);
+bool testStrings();
+bool testRecords();
+bool testRecords(Endian endian);
+bool testColumnar();
+bool testCompressed();
+bool testChecksum();
+bool testStats();
+bool testAsyncLog();
+bool testLogTime();
+bool testBinaryLog();
+bool testSharedAppend();
+bool testSyncMarker();
+bool testSyncMarker(int syncInterval, int recordInterval);
+bool testMappedLittleEndian();
+bool testMappedBigEndian();
+bool testMapped(MappedBinaryReader& br, const char* staticBytes);
 
 int main(int argc, char** argv) {
 	bool allTestsPassed = true;
@@ -254,6 +388,16 @@ int main(int argc, char** argv) {
 	LOG_INFO("BitConverterBigEndian test: %s", ret ? "PASS" : "FAIL");
 	allTestsPassed = ret ? allTestsPassed : false;
 
+	LOG_INFO("Testing bit converter buffers (little endian)");
+	ret = testBitConverterBufferLittleEndian();
+	LOG_INFO("BitConverterBufferLittleEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing bit converter buffers (big endian)");
+	ret = testBitConverterBufferBigEndian();
+	LOG_INFO("BitConverterBufferBigEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
 	LOG_INFO("Testing read (little endian)");
 	ret = testReadLittleEndian();
 	LOG_INFO("ReadLittleEndian test: %s", ret ? "PASS" : "FAIL");
@@ -274,6 +418,141 @@ int main(int argc, char** argv) {
 	LOG_INFO("WriteBigEndian test: %s", ret ? "PASS" : "FAIL");
 	allTestsPassed = ret ? allTestsPassed : false;
 
+	LOG_INFO("Testing compile time endian read");
+	ret = testFixedEndianRead();
+	LOG_INFO("FixedEndianRead test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing compile time endian write");
+	ret = testFixedEndianWrite();
+	LOG_INFO("FixedEndianWrite test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing fstream backend");
+	ret = testFstreamBackend();
+	LOG_INFO("FstreamBackend test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing missing file");
+	ret = testMissingFile();
+	LOG_INFO("MissingFile test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing io_uring backend");
+	ret = testIoUringBackend();
+	LOG_INFO("IoUringBackend test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing bulk arrays (little endian)");
+	ret = testArrayLittleEndian();
+	LOG_INFO("ArrayLittleEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing bulk arrays (big endian)");
+	ret = testArrayBigEndian();
+	LOG_INFO("ArrayBigEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing byte views and readInto");
+	ret = testReadBytes();
+	LOG_INFO("ReadBytes test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing minimum buffer size");
+	ret = testSmallBuffer();
+	LOG_INFO("SmallBuffer test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing adaptive buffer size");
+	ret = testAdaptiveBuffer();
+	LOG_INFO("AdaptiveBuffer test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing asynchronous flush");
+	ret = testAsyncFlush();
+	LOG_INFO("AsyncFlush test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing seek, skip and positional reads");
+	ret = testSeek();
+	LOG_INFO("Seek test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing parallel range reads");
+	ret = testParallelRead();
+	LOG_INFO("ParallelRead test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing varint and Stream VByte encodings");
+	ret = testVarint();
+	LOG_INFO("Varint test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing length prefixed strings");
+	ret = testStrings();
+	LOG_INFO("Strings test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing record layouts");
+	ret = testRecords();
+	LOG_INFO("Records test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing columnar blocks");
+	ret = testColumnar();
+	LOG_INFO("Columnar test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing compressed blocks");
+	ret = testCompressed();
+	LOG_INFO("Compressed test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing block checksums");
+	ret = testChecksum();
+	LOG_INFO("Checksum test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing I/O statistics");
+	ret = testStats();
+	LOG_INFO("Stats test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing asynchronous logging");
+	ret = testAsyncLog();
+	LOG_INFO("AsyncLog test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing cached log timestamps");
+	ret = testLogTime();
+	LOG_INFO("LogTime test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing binary log records");
+	ret = testBinaryLog();
+	LOG_INFO("BinaryLog test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing shared appends");
+	ret = testSharedAppend();
+	LOG_INFO("SharedAppend test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing sync markers");
+	ret = testSyncMarker();
+	LOG_INFO("SyncMarker test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing mapped read (little endian)");
+	ret = testMappedLittleEndian();
+	LOG_INFO("MappedLittleEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
+	LOG_INFO("Testing mapped read (big endian)");
+	ret = testMappedBigEndian();
+	LOG_INFO("MappedBigEndian test: %s", ret ? "PASS" : "FAIL");
+	allTestsPassed = ret ? allTestsPassed : false;
+
 	return (allTestsPassed ? 0 : 1);
 }
 
@@ -316,6 +595,31 @@ void removeTestFiles() {
 	remove(TEST_STATICLE);
 	remove(TEST_WRITEBE);
 	remove(TEST_STATICBE);
+	remove(TEST_FIXEDWRITELE);
+	remove(TEST_FIXEDWRITEBE);
+	remove(TEST_FSTREAMWRITE);
+	remove(TEST_IOURING);
+	remove(TEST_ARRAYLE);
+	remove(TEST_ARRAYBE);
+	remove(TEST_BYTES);
+	remove(TEST_SMALLBUFFER);
+	remove(TEST_ADAPTIVE);
+	remove(TEST_ASYNC);
+	remove(TEST_SEEK);
+	remove(TEST_PARALLEL);
+	remove(TEST_VARINT);
+	remove(TEST_STRINGS);
+	remove(TEST_RECORDS);
+	remove(TEST_RECORDFIELDS);
+	remove(TEST_COLUMNAR);
+	remove(TEST_COMPRESSED);
+	remove(TEST_COMPRESSEDCORRUPT);
+	remove(TEST_CHECKSUM);
+	remove(TEST_STATS);
+	remove(TEST_BINARYLOG);
+	remove(TEST_BINARYLOGSPARSE);
+	remove(TEST_SHAREDAPPEND);
+	remove(TEST_SYNCMARKER);
 }
 
 void writeTestStaticFiles() {
@@ -558,6 +862,109 @@ bool testBitConverter(Endian endian, const vector<byte>* staticBytes) {
 	return true;
 }
 
+bool testBitConverterBufferLittleEndian() {
+	return testBitConverterBuffer(Little, littleEndianVectors);
+}
+
+bool testBitConverterBufferBigEndian() {
+	return testBitConverterBuffer(Big, bigEndianVectors);
+}
+
+bool testBitConverterBuffer(Endian endian, const vector<byte>* staticBytes) {
+	// the explicit byte order must win over the global override
+	BitConverter::forceSetEndian((endian == Little) ? Big : Little);
+
+	for (int i = 0; i < TEST_VALUECOUNT; i++) {
+		byte bytes[8] = { };
+		const byte* expected = staticBytes[i].data();
+		bool match = true;
+
+		switch (testValues[i].type) {
+			case Bool:
+				BitConverter::getBytes(testValues[i].value.vBool, bytes, endian);
+				match = (BitConverter::getBool(expected, endian) == testValues[i].value.vBool);
+				break;
+			case Byte:
+				BitConverter::getBytes(testValues[i].value.vByte, bytes, endian);
+				match = (BitConverter::getUChar(expected, endian) == testValues[i].value.vByte);
+				break;
+			case Char:
+				BitConverter::getBytes(testValues[i].value.vChar, bytes, endian);
+				match = (BitConverter::getChar(expected, endian) == testValues[i].value.vChar);
+				break;
+			case SChar:
+				BitConverter::getBytes(testValues[i].value.vSChar, bytes, endian);
+				match = (BitConverter::getSChar(expected, endian) == testValues[i].value.vSChar);
+				break;
+			case UChar:
+				BitConverter::getBytes(testValues[i].value.vUChar, bytes, endian);
+				match = (BitConverter::getUChar(expected, endian) == testValues[i].value.vUChar);
+				break;
+			case Float:
+				BitConverter::getBytes(testValues[i].value.vFloat, bytes, endian);
+				match = (BitConverter::getFloat(expected, endian) == testValues[i].value.vFloat);
+				break;
+			case Double:
+				BitConverter::getBytes(testValues[i].value.vDouble, bytes, endian);
+				match = (BitConverter::getDouble(expected, endian) == testValues[i].value.vDouble);
+				break;
+			case Int8:
+				BitConverter::getBytes((signed char)testValues[i].value.vInt8, bytes, endian);
+				match = (BitConverter::getInt8(expected, endian) == testValues[i].value.vInt8);
+				break;
+			case Int16:
+				BitConverter::getBytes(testValues[i].value.vInt16, bytes, endian);
+				match = (BitConverter::getInt16(expected, endian) == testValues[i].value.vInt16);
+				break;
+			case Int32:
+				BitConverter::getBytes(testValues[i].value.vInt32, bytes, endian);
+				match = (BitConverter::getInt32(expected, endian) == testValues[i].value.vInt32);
+				break;
+			case Int64:
+				BitConverter::getBytes(testValues[i].value.vInt64, bytes, endian);
+				match = (BitConverter::getInt64(expected, endian) == testValues[i].value.vInt64);
+				break;
+			case UInt8:
+				BitConverter::getBytes((unsigned char)testValues[i].value.vUInt8, bytes, endian);
+				match = (BitConverter::getUInt8(expected, endian) == testValues[i].value.vUInt8);
+				break;
+			case UInt16:
+				BitConverter::getBytes(testValues[i].value.vUInt16, bytes, endian);
+				match = (BitConverter::getUInt16(expected, endian) == testValues[i].value.vUInt16);
+				break;
+			case UInt32:
+				BitConverter::getBytes(testValues[i].value.vUInt32, bytes, endian);
+				match = (BitConverter::getUInt32(expected, endian) == testValues[i].value.vUInt32);
+				break;
+			case UInt64:
+				BitConverter::getBytes(testValues[i].value.vUInt64, bytes, endian);
+				match = (BitConverter::getUInt64(expected, endian) == testValues[i].value.vUInt64);
+				break;
+			default:
+				LOG_INFO("testValues[%d].type is invalid", i);
+				return false;
+		}
+
+		if (!match) {
+			LOG_INFO("buffer getter value incorrect for testValues[%i]", i);
+			return false;
+		}
+		if (memcmp(bytes, expected, staticBytes[i].size()) != 0) {
+			LOG_INFO("buffer getBytes value incorrect for testValues[%i]; expected: %s, actual: %s", i, bytesToString(staticBytes[i]).c_str(), bytesToString(vector<byte>(bytes, bytes + staticBytes[i].size())).c_str());
+			return false;
+		}
+	}
+
+	std::array<byte, 4> array = BitConverter::getBytes((int32_t)16909060, endian);
+	if (BitConverter::getInt32(array.data(), endian) != 16909060) {
+		LOG_INFO("std::array getBytes round trip failed");
+		return false;
+	}
+
+	BitConverter::forceUnsetEndian();
+	return true;
+}
+
 bool testReadLittleEndian() {
 	BinaryReader br(TEST_STATICLE);
 	br.forceSetEndian(Little);
@@ -570,7 +977,8 @@ bool testReadBigEndian() {
 	return testRead(br);
 }
 
-bool testRead(BinaryReader& br) {
+template <typename Reader>
+bool testRead(Reader& br) {
 	for (int i = 0; i < TEST_VALUECOUNT; i++) {
 		switch (testValues[i].type) {
 			case Bool: {
@@ -790,7 +1198,8 @@ bool testWriteBigEndian() {
 	}
 }
 
-bool testWrite(BinaryWriter& bw) {
+template <typename Writer>
+bool testWrite(Writer& bw) {
 	for (int i = 0; i < TEST_VALUECOUNT; i++) {
 		switch (testValues[i].type) {
 			case Bool:
@@ -906,3 +1315,1452 @@ bool testWrite(BinaryWriter& bw) {
 
 	return true;
 }
+
+bool testFixedEndianRead() {
+	LittleEndianBinaryReader brLE(TEST_STATICLE);
+	if (!testRead(brLE)) {
+		return false;
+	}
+
+	BigEndianBinaryReader brBE(TEST_STATICBE);
+	return testRead(brBE);
+}
+
+bool testFixedEndianWrite() {
+	bool testRet;
+	{
+		LittleEndianBinaryWriter bw(TEST_FIXEDWRITELE);
+		testRet = testWrite(bw);
+	}
+	if (!testRet || !compareFiles(TEST_FIXEDWRITELE, TEST_STATICLE)) {
+		return false;
+	}
+
+	{
+		BigEndianBinaryWriter bw(TEST_FIXEDWRITEBE);
+		testRet = testWrite(bw);
+	}
+	if (!testRet) {
+		return false;
+	}
+	return compareFiles(TEST_FIXEDWRITEBE, TEST_STATICBE);
+}
+
+bool testFstreamBackend() {
+	bool testRet;
+	{
+		BinaryWriter bw(TEST_FSTREAMWRITE, true, BinaryIOBase::DEFAULT_BUFFERSIZE, 0, FstreamBackend);
+		bw.forceSetEndian(Little);
+		testRet = testWrite(bw);
+	}
+	if (!testRet || !compareFiles(TEST_FSTREAMWRITE, TEST_STATICLE)) {
+		return false;
+	}
+
+	BinaryReader br(TEST_STATICBE, BinaryIOBase::DEFAULT_BUFFERSIZE, 0, FstreamBackend);
+	br.forceSetEndian(Big);
+	if (!testRead(br)) {
+		return false;
+	}
+
+	br.readByte();
+	if (br.getError() != NotEnoughData) {
+		LOG_INFO("readByte past the end of file did not report NotEnoughData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testMissingFile() {
+	BinaryReader br(TEST_MISSING);
+	if (br.getError() != FileDoesNotExist) {
+		LOG_INFO("Opening a missing file did not report FileDoesNotExist");
+		return false;
+	}
+
+	br.readInt32();
+	return (br.getError() == FileDoesNotExist);
+}
+
+bool testIoUringBackend() {
+	BinaryReader br(TEST_STATICLE, BinaryIOBase::DEFAULT_BUFFERSIZE, 0, IoUringBackend);
+	br.forceSetEndian(Little);
+	if (!testRead(br) || br.moreData()) {
+		return false;
+	}
+
+	vector<uint64_t> values(TEST_IOURINGCOUNT);
+	for (int i = 0; i < TEST_IOURINGCOUNT; i++) {
+		values[i] = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+	}
+	{
+		BinaryWriter bw(TEST_IOURING, true);
+		bw.writeArray(values.data(), TEST_IOURINGCOUNT);
+	}
+
+	// a shallow queue of small blocks recycles every slot many times over
+	IoUringStream* stream = new IoUringStream(2, 4096);
+	BinaryReader brRing(stream, TEST_IOURING, 1000);
+	LOG_INFO("io_uring %s", stream->isAsync() ? "available" : "unavailable; using read fallback");
+
+	vector<uint64_t> readValues(TEST_IOURINGCOUNT);
+	for (int i = 0; i < TEST_IOURINGCOUNT; i++) {
+		readValues[i] = brRing.readUInt64();
+	}
+	if (brRing.hasError() || (readValues != values) || brRing.moreData()) {
+		LOG_INFO("Values read through io_uring do not match");
+		return false;
+	}
+
+	return true;
+}
+
+bool testArrayLittleEndian() {
+	return testArray(Little, TEST_ARRAYLE);
+}
+
+bool testArrayBigEndian() {
+	return testArray(Big, TEST_ARRAYBE);
+}
+
+bool testArray(Endian endian, const char* fileName) {
+	vector<int16_t> int16s(TEST_ARRAYCOUNT);
+	vector<int32_t> int32s(TEST_ARRAYCOUNT);
+	vector<double> doubles(TEST_ARRAYCOUNT);
+	vector<uint64_t> uint64s(TEST_ARRAYCOUNT);
+
+	for (int i = 0; i < TEST_ARRAYCOUNT; i++) {
+		int16s[i] = (int16_t)(i * 7 - 32000);
+		int32s[i] = i * 214013 - 2531011;
+		doubles[i] = i * -1.25;
+		uint64s[i] = (uint64_t)i * 0x0102030405060708ULL;
+	}
+
+	{
+		BinaryWriter bw(fileName, true);
+		bw.forceSetEndian(endian);
+		// a single leading byte keeps the wider arrays unaligned in the buffer
+		bw.write('x');
+		bw.writeArray(int16s.data(), TEST_ARRAYCOUNT);
+		bw.writeArray(int32s.data(), TEST_ARRAYCOUNT);
+		bw.writeArray(doubles.data(), TEST_ARRAYCOUNT);
+		bw.write(uint64s[0]);
+		bw.writeArray(uint64s.data() + 1, TEST_ARRAYCOUNT - 1);
+		if (bw.hasError()) {
+			LOG_INFO("Write error");
+			return false;
+		}
+	}
+
+	BinaryReader br(fileName);
+	br.forceSetEndian(endian);
+	vector<int16_t> readInt16s(TEST_ARRAYCOUNT);
+	vector<int32_t> readInt32s(TEST_ARRAYCOUNT);
+	vector<double> readDoubles(TEST_ARRAYCOUNT);
+	vector<uint64_t> readUInt64s(TEST_ARRAYCOUNT);
+
+	if (br.readChar() != 'x') {
+		LOG_INFO("readChar value incorrect for leading byte");
+		return false;
+	}
+	br.readArray(readInt16s.data(), TEST_ARRAYCOUNT);
+	readInt32s[0] = br.readInt32();
+	br.readArray(readInt32s.data() + 1, TEST_ARRAYCOUNT - 1);
+	br.readArray(readDoubles.data(), TEST_ARRAYCOUNT);
+	br.readArray(readUInt64s.data(), TEST_ARRAYCOUNT);
+	if (br.hasError()) {
+		LOG_INFO("Read error");
+		return false;
+	}
+
+	if ((readInt16s != int16s) || (readInt32s != int32s) || (readDoubles != doubles) || (readUInt64s != uint64s)) {
+		LOG_INFO("readArray values do not match writeArray values");
+		return false;
+	}
+
+	if (br.moreData()) {
+		LOG_INFO("moreData reported data past the end of file");
+		return false;
+	}
+	br.readArray(readInt32s.data(), 1);
+	if (br.getError() != NotEnoughData) {
+		LOG_INFO("readArray past the end of file did not report NotEnoughData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testReadBytes() {
+	vector<byte> bytes(TEST_RAWBYTECOUNT);
+	for (int i = 0; i < TEST_RAWBYTECOUNT; i++) {
+		bytes[i] = (byte)(i * 31);
+	}
+
+	{
+		BinaryWriter bw(TEST_BYTES, true);
+		bw.write(bytes);
+		if (bw.hasError()) {
+			LOG_INFO("Write error");
+			return false;
+		}
+	}
+	{
+		// appends nothing; a negative count must not reach past the range
+		BinaryWriter bw(TEST_BYTES);
+		bw.write(bytes, 5, -2);
+		if (bw.getError() != NotEnoughData) {
+			LOG_INFO("write with a negative count did not report NotEnoughData");
+			return false;
+		}
+	}
+
+	BinaryReader br(TEST_BYTES);
+	int pos = 0;
+
+	// views of 1000 bytes cross the internal buffer boundary
+	for (; pos < 20000; pos += 1000) {
+		ByteView view = br.readBytesView(1000);
+		if (br.hasError() || (view.size != 1000) || !std::equal(view.begin(), view.end(), bytes.begin() + pos)) {
+			LOG_INFO("readBytesView value incorrect at offset %i", pos);
+			return false;
+		}
+	}
+
+	ByteView tooLarge = br.readBytesView(TEST_RAWBYTECOUNT);
+	if (br.hasError() || !tooLarge.empty()) {
+		LOG_INFO("readBytesView larger than the buffer did not return an empty view");
+		return false;
+	}
+
+	vector<byte> into;
+	br.readInto(into, 20000);
+	if (br.hasError() || !std::equal(into.begin(), into.end(), bytes.begin() + pos)) {
+		LOG_INFO("readInto value incorrect at offset %i", pos);
+		return false;
+	}
+	pos += 20000;
+
+	vector<byte> rest = br.readBytes(TEST_RAWBYTECOUNT - pos);
+	if (br.hasError() || !std::equal(rest.begin(), rest.end(), bytes.begin() + pos)) {
+		LOG_INFO("readBytes value incorrect at offset %i", pos);
+		return false;
+	}
+
+	br.readBytesView(1);
+	if (br.getError() != NotEnoughData) {
+		LOG_INFO("readBytesView past the end of file did not report NotEnoughData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testSmallBuffer() {
+	// every multi byte value straddles a refill or flush at some point
+	bool testRet;
+	{
+		BinaryWriter bw(TEST_SMALLBUFFER, true, BinaryIOBase::MIN_BUFFERSIZE);
+		bw.forceSetEndian(Big);
+		testRet = testWrite(bw);
+	}
+	if (!testRet || !compareFiles(TEST_SMALLBUFFER, TEST_STATICBE)) {
+		return false;
+	}
+
+	BinaryReader br(TEST_STATICLE, BinaryIOBase::MIN_BUFFERSIZE);
+	br.forceSetEndian(Little);
+	return testRead(br);
+}
+
+bool testAdaptiveBuffer() {
+	vector<uint32_t> values(TEST_ADAPTIVECOUNT);
+	for (int i = 0; i < TEST_ADAPTIVECOUNT; i++) {
+		values[i] = (uint32_t)i * 2654435761U;
+	}
+
+	{
+		BinaryWriter bw(TEST_ADAPTIVE, true, 4096, 4096);
+		bw.enableAdaptiveBuffer(1 << 20);
+		// pieces smaller than the buffer, as larger ones bypass it
+		for (int i = 0; i < TEST_ADAPTIVECOUNT; i += 1000) {
+			bw.writeArray(values.data() + i, std::min(1000, TEST_ADAPTIVECOUNT - i));
+		}
+		if (bw.hasError() || (bw.getBufferSize() != (1 << 20))) {
+			LOG_INFO("Writer buffer did not grow; size = %i", bw.getBufferSize());
+			return false;
+		}
+	}
+
+	BinaryReader br(TEST_ADAPTIVE, 4096, 4096);
+	br.enableAdaptiveBuffer(1 << 20);
+	vector<uint32_t> readValues(TEST_ADAPTIVECOUNT);
+	for (int i = 0; i < TEST_ADAPTIVECOUNT; i += 1000) {
+		br.readArray(readValues.data() + i, std::min(1000, TEST_ADAPTIVECOUNT - i));
+	}
+	if (br.hasError() || (readValues != values)) {
+		LOG_INFO("readArray values do not match writeArray values");
+		return false;
+	}
+	if (br.getBufferSize() != (1 << 20)) {
+		LOG_INFO("Reader buffer did not grow; size = %i", br.getBufferSize());
+		return false;
+	}
+
+	return true;
+}
+
+bool testAsyncFlush() {
+	vector<uint64_t> values(TEST_ASYNCCOUNT);
+	for (int i = 0; i < TEST_ASYNCCOUNT; i++) {
+		values[i] = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+	}
+
+	{
+		// a small buffer and only two of them keeps the producer waiting on
+		// the flusher thread for most of the run
+		BinaryWriter bw(TEST_ASYNC, true, 4096);
+		bw.forceSetEndian(Big);
+		bw.enableAsyncFlush(2);
+		for (int i = 0; i < TEST_ASYNCCOUNT / 2; i++) {
+			bw.write(values[i]);
+		}
+		bw.sync();
+		if (bw.hasError() || (BinaryReader(TEST_ASYNC).readBytes(8).size() != 8)) {
+			LOG_INFO("sync did not push buffered data to the file");
+			return false;
+		}
+		// large writes must still go through the buffer rotation in order
+		bw.writeArray(values.data() + TEST_ASYNCCOUNT / 2, TEST_ASYNCCOUNT / 2);
+		bw.disableAsyncFlush();
+		if (bw.hasError()) {
+			return false;
+		}
+	}
+
+	BinaryReader br(TEST_ASYNC);
+	br.forceSetEndian(Big);
+	vector<uint64_t> readValues(TEST_ASYNCCOUNT);
+	br.readArray(readValues.data(), TEST_ASYNCCOUNT);
+	if (br.hasError() || br.moreData() || (readValues != values)) {
+		LOG_INFO("Values written through the flusher thread do not match");
+		return false;
+	}
+
+	return true;
+}
+
+bool testMappedLittleEndian() {
+	MappedBinaryReader br(TEST_STATICLE);
+	br.forceSetEndian(Little);
+	return testMapped(br, littleEndianBytes);
+}
+
+bool testMappedBigEndian() {
+	MappedBinaryReader br(TEST_STATICBE);
+	br.forceSetEndian(Big);
+	return testMapped(br, bigEndianBytes);
+}
+
+bool testMapped(MappedBinaryReader& br, const char* staticBytes) {
+	if (br.hasError() || (br.getSize() != TEST_BYTECOUNT)) {
+		LOG_INFO("Mapping error");
+		return false;
+	}
+	if (!testRead(br)) {
+		return false;
+	}
+	if (!br.readBytes(-1).empty() || br.hasError()) {
+		LOG_INFO("readBytes with a negative count did not return an empty vector");
+		return false;
+	}
+
+	if (br.moreData()) {
+		LOG_INFO("moreData reported data past the end of file");
+		return false;
+	}
+	br.readByte();
+	if (br.getError() != NotEnoughData) {
+		LOG_INFO("readByte past the end of file did not report NotEnoughData");
+		return false;
+	}
+
+	// the view must point straight at the mapped file contents
+	ByteView view = br.view(TEST_BYTECOUNT - 8, 8);
+	if ((view.size != 8) || (memcmp(view.data, staticBytes + TEST_BYTECOUNT - 8, 8) != 0)) {
+		LOG_INFO("view does not match the file contents");
+		return false;
+	}
+
+	return true;
+}
+
+bool testSeek() {
+	vector<uint32_t> values(TEST_SEEKCOUNT);
+	for (int i = 0; i < TEST_SEEKCOUNT; i++) {
+		values[i] = (uint32_t)i * 2654435761U;
+	}
+	{
+		BinaryWriter bw(TEST_SEEK, true);
+		bw.forceSetEndian(Little);
+		bw.writeArray(values.data(), TEST_SEEKCOUNT);
+	}
+
+	BinaryReader br(TEST_SEEK, 4096);
+	br.forceSetEndian(Little);
+	for (int i = 0; i < 10; i++) {
+		br.readUInt32();
+	}
+	if (br.tell() != 40) {
+		LOG_INFO("tell after sequential reads is %i", (int)br.tell());
+		return false;
+	}
+
+	// backwards inside the buffered window
+	if (!br.seek(8) || (br.readUInt32() != values[2])) {
+		LOG_INFO("seek inside the buffer read the wrong value");
+		return false;
+	}
+	// well past the buffer, then forwards and backwards again
+	if (!br.seek(4 * 15000) || (br.readUInt32() != values[15000])) {
+		LOG_INFO("seek past the buffer read the wrong value");
+		return false;
+	}
+	if (!br.skip(4 * 10) || (br.tell() != 4 * 15011) || (br.readUInt32() != values[15011])) {
+		LOG_INFO("skip read the wrong value");
+		return false;
+	}
+	if (!br.seek(4 * 3) || (br.readUInt32() != values[3])) {
+		LOG_INFO("seek back to the start read the wrong value");
+		return false;
+	}
+
+	uint32_t value;
+	uint64_t position = br.tell();
+	if ((br.readAt(4 * 12345, (byte*)&value, 4) != 4) || (value != values[12345]) || (br.tell() != position)) {
+		LOG_INFO("readAt read the wrong value or moved the position");
+		return false;
+	}
+	if (br.readAt(4 * TEST_SEEKCOUNT - 2, (byte*)&value, 4) != 2) {
+		LOG_INFO("readAt across the end of file did not return a short count");
+		return false;
+	}
+
+	// running off the end is recoverable by seeking back
+	br.seek(4 * TEST_SEEKCOUNT);
+	br.readUInt32();
+	if (br.getError() != NotEnoughData) {
+		LOG_INFO("read at the end of file did not report NotEnoughData");
+		return false;
+	}
+	if (!br.seek(4 * 100) || (br.readUInt32() != values[100]) || br.hasError()) {
+		LOG_INFO("seek did not recover from NotEnoughData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testParallelRead() {
+	vector<uint64_t> values(TEST_PARALLELCOUNT);
+	uint64_t total = 0;
+	for (int i = 0; i < TEST_PARALLELCOUNT; i++) {
+		values[i] = (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+		total += values[i];
+	}
+	{
+		BinaryWriter bw(TEST_PARALLEL, true);
+		bw.forceSetEndian(Big);
+		bw.writeArray(values.data(), TEST_PARALLELCOUNT);
+	}
+
+	ParallelBinaryReader pr(TEST_PARALLEL, 4, 4096);
+	pr.forceSetEndian(Big);
+	if (pr.hasError() || (pr.getSize() != 8ULL * TEST_PARALLELCOUNT)) {
+		LOG_INFO("Parallel reader could not open the file");
+		return false;
+	}
+
+	// more ranges than threads, and a record count that does not divide
+	vector<BinaryRange> ranges = pr.partition(8, 7);
+	if ((ranges.size() != 7) || (ranges.front().begin != 0) || (ranges.back().end != pr.getSize())) {
+		LOG_INFO("partition did not cover the file");
+		return false;
+	}
+	for (size_t i = 0; i < ranges.size(); i++) {
+		if ((ranges[i].begin % 8 != 0) || ((i > 0) && (ranges[i].begin != ranges[i - 1].end))) {
+			LOG_INFO("partition produced a misaligned or overlapping range");
+			return false;
+		}
+	}
+
+	// every range reports its first value, so the order can be checked
+	vector<uint64_t> firsts = pr.map<uint64_t>(ranges, [](BinaryReader& br, const BinaryRange&, size_t) {
+		return br.readUInt64();
+	});
+	for (size_t i = 0; i < ranges.size(); i++) {
+		if (firsts[i] != values[ranges[i].begin / 8]) {
+			LOG_INFO("map results are out of range order");
+			return false;
+		}
+	}
+
+	auto sumRange = [](BinaryReader& br, const BinaryRange&, size_t) {
+		uint64_t sum = 0;
+		while (br.moreData()) {
+			sum += br.readUInt64();
+		}
+		return br.hasError() ? 0 : sum;
+	};
+	auto add = [](uint64_t a, uint64_t b) {
+		return a + b;
+	};
+	if (pr.mapReduce<uint64_t>(ranges, sumRange, 0, add) != total) {
+		LOG_INFO("Parallel sum does not match");
+		return false;
+	}
+
+	// caller supplied boundaries, unsorted and with duplicates
+	vector<uint64_t> boundaries = { 8 * 70000, 8 * 10, 8 * 10, 8 * 33333 };
+	ranges = pr.partition(boundaries);
+	if ((ranges.size() != 4) || (pr.mapReduce<uint64_t>(ranges, sumRange, 0, add) != total)) {
+		LOG_INFO("Parallel sum over caller boundaries does not match");
+		return false;
+	}
+
+	return true;
+}
+
+bool testVarint() {
+	// the minimum buffer forces every slow path, the default every fast one
+	if (!testVarint(BinaryIOBase::MIN_BUFFERSIZE) || !testVarint(BinaryIOBase::DEFAULT_BUFFERSIZE)) {
+		return false;
+	}
+
+	// eleven continuation bytes can never be a valid value
+	{
+		BinaryWriter bw(TEST_VARINT, true);
+		for (int i = 0; i < 11; i++) {
+			bw.write((uint8_t)0x80);
+		}
+	}
+	BinaryReader br(TEST_VARINT);
+	br.readVarUInt();
+	if (br.getError() != InvalidData) {
+		LOG_INFO("Overlong varint did not report InvalidData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testVarint(int bufferSize) {
+	const uint64_t unsignedValues[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFFULL, 1ULL << 63, 0xFFFFFFFFFFFFFFFFULL };
+	const int64_t signedValues[] = { 0, -1, 1, -64, 64, INT32_MIN, INT32_MAX, INT64_MIN, INT64_MAX };
+	const int unsignedCount = sizeof(unsignedValues) / sizeof(unsignedValues[0]);
+	const int signedCount = sizeof(signedValues) / sizeof(signedValues[0]);
+
+	// mostly small values with the odd large one, in every length class
+	vector<uint32_t> values(TEST_VARINTCOUNT);
+	vector<int32_t> deltas(TEST_VARINTCOUNT);
+	for (int i = 0; i < TEST_VARINTCOUNT; i++) {
+		uint32_t hash = (uint32_t)i * 2654435761U;
+		values[i] = hash >> (8 * (hash & 3));
+		deltas[i] = (int32_t)(hash >> 20) - 2048;
+	}
+
+	{
+		BinaryWriter bw(TEST_VARINT, true, bufferSize);
+		for (int i = 0; i < unsignedCount; i++) {
+			bw.writeVarUInt(unsignedValues[i]);
+		}
+		for (int i = 0; i < signedCount; i++) {
+			bw.writeVarInt(signedValues[i]);
+		}
+		bw.writeVarUIntArray(values.data(), TEST_VARINTCOUNT);
+		bw.writeVarIntArray(deltas.data(), TEST_VARINTCOUNT);
+		bw.writeVarUInt(42);
+	}
+
+	BinaryReader br(TEST_VARINT, bufferSize);
+	for (int i = 0; i < unsignedCount; i++) {
+		if (br.readVarUInt() != unsignedValues[i]) {
+			LOG_INFO("readVarUInt mismatch at %i", i);
+			return false;
+		}
+	}
+	for (int i = 0; i < signedCount; i++) {
+		if (br.readVarInt() != signedValues[i]) {
+			LOG_INFO("readVarInt mismatch at %i", i);
+			return false;
+		}
+	}
+
+	vector<uint32_t> readValues(TEST_VARINTCOUNT);
+	vector<int32_t> readDeltas(TEST_VARINTCOUNT);
+	br.readVarUIntArray(readValues.data(), TEST_VARINTCOUNT);
+	br.readVarIntArray(readDeltas.data(), TEST_VARINTCOUNT);
+	if (br.hasError() || (readValues != values) || (readDeltas != deltas)) {
+		LOG_INFO("Stream VByte arrays do not match; buffer size = %i", bufferSize);
+		return false;
+	}
+	if ((br.readVarUInt() != 42) || br.moreData()) {
+		LOG_INFO("Stream VByte arrays consumed the wrong number of bytes");
+		return false;
+	}
+
+	return true;
+}
+
+bool testStrings() {
+	const int bufferSize = 64;
+	const StringPrefix prefixes[] = { UInt16Prefix, UInt32Prefix, VarintPrefix };
+	// empty, short, one with an embedded zero, and one larger than the buffer
+	vector<string> strings = { "", "record", string("a\0b", 3), string(1000, 'x') };
+
+	{
+		BinaryWriter bw(TEST_STRINGS, true, bufferSize);
+		bw.forceSetEndian(Big);
+		for (int p = 0; p < 3; p++) {
+			for (size_t i = 0; i < strings.size(); i++) {
+				bw.writeString(strings[i], prefixes[p]);
+			}
+		}
+		bw.writeString("tail");
+		bw.writeString(string(70000, 'y'), UInt16Prefix);
+		if (bw.getError() != InvalidData) {
+			LOG_INFO("Oversized UInt16 prefixed string did not report InvalidData");
+			return false;
+		}
+	}
+
+	BinaryReader br(TEST_STRINGS, bufferSize);
+	br.forceSetEndian(Big);
+	string reused;
+	reused.reserve(2000);
+	const char* storage = reused.data();
+	for (int p = 0; p < 3; p++) {
+		for (size_t i = 0; i < strings.size(); i++) {
+			if ((p % 2) == 0) {
+				if (br.readStringView(prefixes[p]) != strings[i]) {
+					LOG_INFO("readStringView mismatch; prefix %i string %i", p, (int)i);
+					return false;
+				}
+			} else {
+				br.readString(reused, prefixes[p]);
+				if ((reused != strings[i]) || (reused.data() != storage)) {
+					LOG_INFO("readString mismatch or reallocation; prefix %i string %i", p, (int)i);
+					return false;
+				}
+			}
+		}
+	}
+	if ((br.readString() != "tail") || br.hasError() || br.moreData()) {
+		LOG_INFO("Strings consumed the wrong number of bytes");
+		return false;
+	}
+
+	return true;
+}
+
+bool testRecords() {
+	return testRecords(Little) && testRecords(Big);
+}
+
+bool testRecords(Endian endian) {
+	vector<TestTelemetry> telemetry(TEST_RECORDCOUNT);
+	vector<TestSample> samples(TEST_RECORDCOUNT);
+	for (int i = 0; i < TEST_RECORDCOUNT; i++) {
+		TestTelemetry& t = telemetry[i];
+		t.id = (uint32_t)i * 2654435761U;
+		t.flags = (uint16_t)(i * 31);
+		t.kind = (uint8_t)i;
+		t.level = (int8_t)(-i);
+		t.value = i * 0.25;
+		for (int j = 0; j < 4; j++) {
+			t.axis[j] = (float)(i + j) / 3.0f;
+		}
+		t.time = -(int64_t)i * 1000000007LL;
+		samples[i].tag = (uint8_t)(i * 7);
+		samples[i].count = (uint32_t)i << 12;
+		samples[i].value = -i * 1.5;
+	}
+
+	{
+		BinaryWriter bw(TEST_RECORDS, true, 64);
+		bw.forceSetEndian(endian);
+		bw.writeRecords(telemetry.data(), TEST_RECORDCOUNT);
+		for (int i = 0; i < TEST_RECORDCOUNT; i++) {
+			bw.writeRecord(samples[i]);
+		}
+
+		// the same bytes through the per value API
+		BinaryWriter fields(TEST_RECORDFIELDS, true);
+		fields.forceSetEndian(endian);
+		for (int i = 0; i < TEST_RECORDCOUNT; i++) {
+			TestTelemetry& t = telemetry[i];
+			fields.write(t.id);
+			fields.write(t.flags);
+			fields.write(t.kind);
+			fields.write(t.level);
+			fields.write(t.value);
+			for (int j = 0; j < 4; j++) {
+				fields.write(t.axis[j]);
+			}
+			fields.write(t.time);
+		}
+		for (int i = 0; i < TEST_RECORDCOUNT; i++) {
+			fields.write(samples[i].value);
+			fields.write(samples[i].tag);
+			fields.write(samples[i].count);
+		}
+	}
+	if (!compareFiles(TEST_RECORDS, TEST_RECORDFIELDS)) {
+		LOG_INFO("writeRecords output does not match per field writes");
+		return false;
+	}
+
+	BinaryReader br(TEST_RECORDS, 64);
+	br.forceSetEndian(endian);
+	vector<TestTelemetry> readTelemetry(TEST_RECORDCOUNT);
+	br.readRecords(readTelemetry.data(), TEST_RECORDCOUNT);
+	for (int i = 0; i < TEST_RECORDCOUNT; i++) {
+		TestSample sample;
+		br.readRecord(sample);
+		if ((sample.tag != samples[i].tag) || (sample.count != samples[i].count) || (sample.value != samples[i].value)) {
+			LOG_INFO("readRecord mismatch at %i", i);
+			return false;
+		}
+	}
+	if (br.hasError() || br.moreData() || (memcmp(readTelemetry.data(), telemetry.data(), TEST_RECORDCOUNT * sizeof(TestTelemetry)) != 0)) {
+		LOG_INFO("readRecords mismatch");
+		return false;
+	}
+
+	return true;
+}
+
+bool testColumnar() {
+	{
+		ColumnarBinaryWriter cw(TEST_COLUMNAR, 4096);
+		cw.forceSetEndian(Big);
+		int id = cw.addColumn(UInt64Column);
+		int price = cw.addColumn(DoubleColumn);
+		int flag = cw.addColumn(UInt8Column);
+		int delta = cw.addColumn(Int16Column);
+		int count = cw.addColumn(Int32Column);
+		int weight = cw.addColumn(FloatColumn);
+		for (int i = 0; i < TEST_COLUMNARROWS; i++) {
+			cw.write(id, (uint64_t)(i * 0x9E3779B97F4A7C15ULL));
+			cw.write(price, i * 0.5);
+			cw.write(flag, (uint8_t)i);
+			cw.write(delta, (int16_t)(-i));
+			cw.write(count, (int32_t)i * 3);
+			cw.write(weight, i / 4.0f);
+			cw.endRow();
+		}
+		if (cw.hasError()) {
+			return false;
+		}
+	}
+
+	// only two of the six columns, in reverse order
+	ColumnarBinaryReader cr(TEST_COLUMNAR, 4096);
+	if (cr.hasError() || (cr.getColumnCount() != 6) || (cr.getColumnType(4) != Int32Column)) {
+		LOG_INFO("Columnar header mismatch");
+		return false;
+	}
+	int row = 0;
+	int blocks = 0;
+	vector<int32_t> counts;
+	vector<double> prices;
+	while (cr.nextBlock()) {
+		counts.resize(cr.getBlockRows());
+		prices.resize(cr.getBlockRows());
+		cr.readColumn(4, counts.data());
+		cr.readColumn(1, prices.data());
+		for (int i = 0; i < cr.getBlockRows(); i++, row++) {
+			if ((counts[i] != row * 3) || (prices[i] != row * 0.5)) {
+				LOG_INFO("Column value mismatch at row %i", row);
+				return false;
+			}
+		}
+		blocks++;
+	}
+	if (cr.hasError() || (row != TEST_COLUMNARROWS) || (blocks != 3)) {
+		LOG_INFO("Columnar scan ended early; rows = %i, blocks = %i", row, blocks);
+		return false;
+	}
+
+	// a value of the wrong type for its column is refused
+	ColumnarBinaryWriter cw(TEST_COLUMNAR);
+	int count = cw.addColumn(Int32Column);
+	cw.write(count, 1.0);
+	if (cw.getError() != InvalidData) {
+		LOG_INFO("Column type mismatch did not report InvalidData");
+		return false;
+	}
+
+	return true;
+}
+
+bool testCompressed() {
+	// a compressible run of counters followed by noise that is stored raw
+	vector<uint32_t> counters(TEST_COMPRESSEDCOUNT);
+	vector<uint32_t> noise(TEST_COMPRESSEDCOUNT / 10);
+	for (int i = 0; i < TEST_COMPRESSEDCOUNT; i++) {
+		counters[i] = i / 16;
+	}
+	uint32_t state = 12345;
+	for (size_t i = 0; i < noise.size(); i++) {
+		state = state * 1664525U + 1013904223U;
+		noise[i] = state;
+	}
+
+	{
+		BinaryWriter bw(new CompressedStream(NULL, NULL, 4096), TEST_COMPRESSED, true, 1000);
+		bw.forceSetEndian(Big);
+		if (!testWrite(bw)) {
+			return false;
+		}
+		bw.writeArray(counters.data(), TEST_COMPRESSEDCOUNT);
+		bw.writeArray(noise.data(), (int)noise.size());
+		bw.writeString("end");
+		if (bw.hasError()) {
+			return false;
+		}
+	}
+
+	uint64_t rawSize = TEST_BYTECOUNT + 4 * (uint64_t)(counters.size() + noise.size()) + 4;
+	ifstream compressedFile(TEST_COMPRESSED, ios::ate | ios::binary);
+	if ((uint64_t)compressedFile.tellg() * 2 > rawSize) {
+		LOG_INFO("Compressed file is too large; %i of %i bytes", (int)compressedFile.tellg(), (int)rawSize);
+		return false;
+	}
+
+	BinaryReader br(new CompressedStream(), TEST_COMPRESSED, 1000);
+	br.forceSetEndian(Big);
+	if (!testRead(br)) {
+		return false;
+	}
+	vector<uint32_t> readCounters(TEST_COMPRESSEDCOUNT);
+	vector<uint32_t> readNoise(noise.size());
+	br.readArray(readCounters.data(), TEST_COMPRESSEDCOUNT);
+	br.readArray(readNoise.data(), (int)readNoise.size());
+	if (br.hasError() || (readCounters != counters) || (readNoise != noise) || (br.readString() != "end") || br.moreData()) {
+		LOG_INFO("Decompressed values do not match");
+		return false;
+	}
+
+	// frames decode independently, so any offset can be reached directly
+	uint64_t middle = TEST_BYTECOUNT + 4 * 77777;
+	if (!br.seek(middle) || (br.readUInt32() != counters[77777])) {
+		LOG_INFO("seek into a compressed frame read the wrong value");
+		return false;
+	}
+	uint32_t value;
+	if ((br.readAt(TEST_BYTECOUNT + 4 * (TEST_COMPRESSEDCOUNT + 5), (byte*)&value, 4) != 4) || (BitConverter::getUInt32((const byte*)&value, Big) != noise[5])) {
+		LOG_INFO("readAt from a stored frame read the wrong value");
+		return false;
+	}
+
+	// a stored frame whose sizes disagree must fail, not serve old bytes
+	{
+		BinaryWriter bw(TEST_COMPRESSEDCORRUPT, true);
+		bw.forceSetEndian(Little);
+		bw.write((uint8_t)0);
+		bw.write((uint32_t)8);
+		bw.write((uint32_t)8);
+		bw.writeArray((const uint8_t*)"ABCDEFGH", 8);
+		bw.write((uint8_t)0);
+		bw.write((uint32_t)4);
+		bw.write((uint32_t)8);
+		bw.writeArray((const uint8_t*)"IJKLMNOP", 8);
+	}
+	CompressedStream corrupt;
+	char text[8];
+	if ((corrupt.open(TEST_COMPRESSEDCORRUPT, ios::in) != None) || (corrupt.read(text, 8) != 8) || (memcmp(text, "ABCDEFGH", 8) != 0)) {
+		LOG_INFO("could not read the intact frame");
+		return false;
+	}
+	if ((corrupt.read(text, 8) >= 0) || (corrupt.read(text, 8) >= 0)) {
+		LOG_INFO("read from a corrupt stored frame did not fail");
+		return false;
+	}
+	if (!corrupt.seek(2) || (corrupt.read(text, 8) != 6) || (memcmp(text, "CDEFGH", 6) != 0)) {
+		LOG_INFO("seek after a corrupt frame read the wrong bytes");
+		return false;
+	}
+
+	return true;
+}
+
+bool testChecksum() {
+	// reference value from RFC 3720
+	if (crc32c(0, "123456789", 9) != 0xE3069283) {
+		LOG_INFO("crc32c check value mismatch");
+		return false;
+	}
+
+	const int blockSize = 4096;
+	vector<uint32_t> values(TEST_CHECKSUMCOUNT);
+	for (int i = 0; i < TEST_CHECKSUMCOUNT; i++) {
+		values[i] = (uint32_t)i * 2654435761U;
+	}
+	{
+		BinaryWriter bw(new ChecksumStream(NULL, blockSize), TEST_CHECKSUM, true, 1000);
+		bw.forceSetEndian(Little);
+		if (!testWrite(bw)) {
+			return false;
+		}
+		bw.writeArray(values.data(), TEST_CHECKSUMCOUNT);
+	}
+
+	uint64_t rawSize = TEST_BYTECOUNT + 4 * (uint64_t)TEST_CHECKSUMCOUNT;
+	uint64_t blocks = (rawSize + blockSize - 1) / blockSize;
+	ifstream checkedFile(TEST_CHECKSUM, ios::ate | ios::binary);
+	if ((uint64_t)checkedFile.tellg() != rawSize + blocks * ChecksumStream::TRAILERSIZE) {
+		LOG_INFO("Checksummed file has the wrong size");
+		return false;
+	}
+	checkedFile.close();
+
+	{
+		BinaryReader br(new ChecksumStream(NULL, blockSize), TEST_CHECKSUM, 1000);
+		br.forceSetEndian(Little);
+		if (!testRead(br)) {
+			return false;
+		}
+		vector<uint32_t> readValues(TEST_CHECKSUMCOUNT);
+		br.readArray(readValues.data(), TEST_CHECKSUMCOUNT);
+		if (br.hasError() || (readValues != values) || br.moreData()) {
+			LOG_INFO("Checksummed values do not match");
+			return false;
+		}
+		if (!br.seek(TEST_BYTECOUNT + 4 * 15000) || (br.readUInt32() != values[15000])) {
+			LOG_INFO("seek in a checksummed file read the wrong value");
+			return false;
+		}
+	}
+
+	// the last block is partial; appending must extend it in place
+	{
+		BinaryWriter bw(new ChecksumStream(NULL, blockSize), TEST_CHECKSUM, false, 1000);
+		bw.forceSetEndian(Little);
+		bw.writeArray(values.data(), TEST_CHECKSUMCOUNT);
+		if (bw.hasError()) {
+			LOG_INFO("Appending to a partial checksummed block failed: %d", bw.getError());
+			return false;
+		}
+	}
+	{
+		BinaryReader br(new ChecksumStream(NULL, blockSize), TEST_CHECKSUM, 1000);
+		br.forceSetEndian(Little);
+		vector<uint32_t> readValues(TEST_CHECKSUMCOUNT);
+		br.readBytes(TEST_BYTECOUNT);
+		br.readArray(readValues.data(), TEST_CHECKSUMCOUNT);
+		if (br.hasError() || (readValues != values)) {
+			LOG_INFO("Values in front of the appended ones do not match");
+			return false;
+		}
+		br.readArray(readValues.data(), TEST_CHECKSUMCOUNT);
+		if (br.hasError() || (readValues != values) || br.moreData()) {
+			LOG_INFO("Appended checksummed values do not match");
+			return false;
+		}
+	}
+
+	// flip one bit in the sixth block
+	{
+		fstream file(TEST_CHECKSUM, ios::in | ios::out | ios::binary);
+		file.seekg(5 * (blockSize + ChecksumStream::TRAILERSIZE) + 100);
+		char value = file.get();
+		file.seekp(5 * (blockSize + ChecksumStream::TRAILERSIZE) + 100);
+		file.put(value ^ 0x10);
+	}
+
+	BinaryReader br(new ChecksumStream(NULL, blockSize), TEST_CHECKSUM, 1000);
+	br.forceSetEndian(Little);
+	br.readBytes(5 * blockSize);
+	if (br.hasError()) {
+		LOG_INFO("Intact blocks in front of the damage did not read");
+		return false;
+	}
+	br.readUInt32();
+	if (br.getError() != ChecksumMismatch) {
+		LOG_INFO("Damaged block did not report ChecksumMismatch");
+		return false;
+	}
+
+	return true;
+}
+
+bool testStats() {
+	vector<uint16_t> values(TEST_STATSCOUNT);
+	for (int i = 0; i < TEST_STATSCOUNT; i++) {
+		values[i] = (uint16_t)(i * 7);
+	}
+	uint64_t size = 4 * (uint64_t)TEST_STATSCOUNT + 2 * (uint64_t)TEST_STATSCOUNT + 1 + 5;
+
+	BinaryIOBase::resetGlobalStats();
+	{
+		BinaryWriter bw(TEST_STATS, true, 1000);
+		for (int i = 0; i < TEST_STATSCOUNT; i++) {
+			bw.write((uint32_t)i);
+		}
+		bw.writeArray(values.data(), TEST_STATSCOUNT);
+		bw.writeString("stats");
+		BinaryIOStats stats = bw.getStats();
+		if ((stats.values[UInt32Value] != TEST_STATSCOUNT) || (stats.values[UInt16Value] != TEST_STATSCOUNT) ||
+			(stats.values[StringValue] != 1) || (stats.values[VarintValue] != 0)) {
+			LOG_INFO("Writer value counts are wrong");
+			return false;
+		}
+		if ((stats.flushes == 0) || (stats.streamCalls < stats.flushes) || (stats.bytesWritten >= size) || (stats.bytesRead != 0)) {
+			LOG_INFO("Writer transfer counts are wrong");
+			return false;
+		}
+		bw.sync();
+		uint64_t streamCalls = bw.getStats().streamCalls;
+		bw.sync();
+		if (bw.getStats().streamCalls != streamCalls) {
+			LOG_INFO("An empty flush counted a stream call");
+			return false;
+		}
+	}
+
+	// the final flush happens in the destructor, so only the process wide
+	// view has the complete picture
+	BinaryIOStats written = BinaryIOBase::getGlobalStats();
+	if ((written.bytesWritten != size) || (written.values[UInt32Value] != TEST_STATSCOUNT)) {
+		LOG_INFO("Global writer totals are wrong");
+		return false;
+	}
+
+	BinaryReader br(TEST_STATS, 1000);
+	for (int i = 0; i < TEST_STATSCOUNT; i++) {
+		br.readUInt32();
+	}
+	vector<uint16_t> readValues(TEST_STATSCOUNT);
+	br.readArray(readValues.data(), TEST_STATSCOUNT);
+	if ((br.readString() != "stats") || br.hasError() || (readValues != values)) {
+		LOG_INFO("Values read back wrong");
+		return false;
+	}
+	BinaryIOStats stats = br.getStats();
+	if ((stats.bytesRead != size) || (stats.refills == 0) || (stats.streamCalls < stats.refills) || (stats.bytesWritten != 0)) {
+		LOG_INFO("Reader transfer counts are wrong");
+		return false;
+	}
+	if ((stats.values[UInt32Value] != TEST_STATSCOUNT) || (stats.values[UInt16Value] != TEST_STATSCOUNT) ||
+		(stats.values[StringValue] != 1) || (stats.values[VarintValue] != 0)) {
+		LOG_INFO("Reader value counts are wrong");
+		return false;
+	}
+
+	br.resetStats();
+	stats = br.getStats();
+	if ((stats.bytesRead != 0) || (stats.values[UInt32Value] != 0)) {
+		LOG_INFO("resetStats did not clear the counters");
+		return false;
+	}
+
+	return true;
+}
+
+bool testAsyncLog() {
+	string longLine(1000, 'x');
+
+	// a small ring so producers regularly have to wait for the drain thread
+	Logger::Instance()->enableAsync(64, 1000, BlockOnOverflow);
+	vector<std::thread> threads;
+	for (int t = 0; t < TEST_ASYNCLOGTHREADS; t++) {
+		threads.push_back(std::thread([t] {
+			for (int i = 0; i < TEST_ASYNCLOGCOUNT; i++) {
+				Logger::Instance()->log("asynclog %d %d\n", t, i);
+			}
+		}));
+	}
+	Logger::Instance()->log("asynclong %s\n", longLine.c_str());
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	Logger::Instance()->closeLogFile();
+
+	vector<int> next(TEST_ASYNCLOGTHREADS, 0);
+	bool longFound = false;
+	string line;
+	ifstream logFile(BINARYIO_LOG);
+	while (std::getline(logFile, line)) {
+		int t, i;
+		if (sscanf(line.c_str(), "asynclog %d %d", &t, &i) == 2) {
+			if ((t < 0) || (t >= TEST_ASYNCLOGTHREADS) || (i != next[t])) {
+				LOG_INFO("Asynchronous log lines lost or out of order");
+				return false;
+			}
+			next[t]++;
+		} else if (line == "asynclong " + longLine) {
+			longFound = true;
+		}
+	}
+	logFile.close();
+	Logger::Instance()->openLogFile(BINARYIO_LOG);
+	Logger::Instance()->disableAsync();
+	for (int t = 0; t < TEST_ASYNCLOGTHREADS; t++) {
+		if (next[t] != TEST_ASYNCLOGCOUNT) {
+			LOG_INFO("Asynchronous log is missing lines of thread %d", t);
+			return false;
+		}
+	}
+	if (!longFound) {
+		LOG_INFO("Long asynchronous log line was not written intact");
+		return false;
+	}
+
+	// the drain thread sleeps for a minute, so a two line ring overflows
+	uint64_t droppedBefore = Logger::Instance()->getDroppedCount();
+	Logger::Instance()->enableAsync(2, 60000, DropOnOverflow);
+	for (int i = 0; i < TEST_ASYNCLOGDROPCOUNT; i++) {
+		Logger::Instance()->log("asyncdrop %d\n", i);
+	}
+	Logger::Instance()->disableAsync();
+	uint64_t dropped = Logger::Instance()->getDroppedCount() - droppedBefore;
+
+	int kept = 0;
+	logFile.open(BINARYIO_LOG);
+	while (std::getline(logFile, line)) {
+		kept += (line.compare(0, 10, "asyncdrop ") == 0) ? 1 : 0;
+	}
+	if ((dropped == 0) || (kept + dropped != TEST_ASYNCLOGDROPCOUNT)) {
+		LOG_INFO("Dropped line count is wrong: %d kept, %llu dropped", kept, (unsigned long long)dropped);
+		return false;
+	}
+
+	// with a long flush interval only the half full wakeup keeps the ring
+	// moving; a drain thread that never woke would lose everything past
+	// the first 4096 lines. Scheduling decides the exact count, so only
+	// check that the drain thread clearly kept up
+	droppedBefore = Logger::Instance()->getDroppedCount();
+	Logger::Instance()->enableAsync(4096, 60000, DropOnOverflow);
+	for (int i = 0; i < TEST_ASYNCLOGBURSTCOUNT; i++) {
+		Logger::Instance()->log("asyncburst %d\n", i);
+		if (i % 100 == 99) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+	Logger::Instance()->disableAsync();
+	dropped = Logger::Instance()->getDroppedCount() - droppedBefore;
+	if (dropped > (TEST_ASYNCLOGBURSTCOUNT - 4096) / 2) {
+		LOG_INFO("Asynchronous log dropped %llu lines with room in the ring", (unsigned long long)dropped);
+		return false;
+	}
+
+	return true;
+}
+
+bool testLogTime() {
+	char expected[2][32];
+	for (int attempt = 0; attempt < 2; attempt++) {
+		time_t before = time(NULL);
+		string cached = currentTime();
+		time_t after = time(NULL);
+		struct tm timeInfo;
+		strftime(expected[0], sizeof(expected[0]), "%Y-%m-%d %H:%M:%S", localtime_r(&before, &timeInfo));
+		strftime(expected[1], sizeof(expected[1]), "%Y-%m-%d %H:%M:%S", localtime_r(&after, &timeInfo));
+		if ((cached != expected[0]) && (cached != expected[1])) {
+			LOG_INFO("Cached timestamp %s does not match the clock", cached.c_str());
+			return false;
+		}
+	}
+
+	// a fresh thread starts with a fresh anchor, so nothing may go backwards
+	bool ordered = true;
+	std::thread worker([&ordered] {
+		string previous = currentTimePrecise();
+		for (int i = 0; i < TEST_LOGTIMECOUNT; i++) {
+			string current = currentTimePrecise();
+			if ((current.size() != 26) || (current[19] != '.') || (current.compare(0, 19, currentTime()) > 0) || (current < previous)) {
+				ordered = false;
+				return;
+			}
+			previous = current;
+		}
+	});
+	worker.join();
+	if (!ordered) {
+		LOG_INFO("Sub-second timestamps are malformed or not monotonic");
+		return false;
+	}
+
+	return true;
+}
+
+bool testBinaryLog() {
+	string longText(700, 'y');
+	vector<string> expected;
+	char line[1024];
+
+	int64_t before = logWallNanoseconds(logTimeCache());
+	{
+		BinaryLogWriter log(TEST_BINARYLOG, 1000);
+		for (int i = 0; i < TEST_BINARYLOGCOUNT; i++) {
+			int64_t offset = -(int64_t)i * 1000003;
+			uint16_t port = (uint16_t)(i * 7);
+			double ratio = i / 3.0;
+			BINARY_LOG(log, "record %d offset %lld port %u ratio %.3f", i, offset, port, ratio);
+			snprintf(line, sizeof(line), "record %d offset %lld port %u ratio %.3f", i, (long long)offset, port, ratio);
+			expected.push_back(line);
+			if (i % 100 == 0) {
+				BINARY_LOG(log, "%-6s|%5x|%c|%*d|%.2s|100%%", "io", (unsigned)i, 'A' + i % 26, 4, i % 10, "abc");
+				snprintf(line, sizeof(line), "%-6s|%5x|%c|%*d|%.2s|100%%", "io", (unsigned)i, 'A' + i % 26, 4, i % 10, "abc");
+				expected.push_back(line);
+			}
+		}
+		BINARY_LOG(log, "long %s", longText);
+		expected.push_back("long " + longText);
+		BINARY_LOG(log, "no arguments");
+		expected.push_back("no arguments");
+		// registering the call site must not evaluate the arguments again
+		int calls = 0;
+		auto next = [&calls]() { return ++calls; };
+		BINARY_LOG(log, "next %d", next());
+		expected.push_back("next 1");
+		if (calls != 1) {
+			LOG_INFO("Binary log arguments were evaluated %d times", calls);
+			return false;
+		}
+		if (log.hasError()) {
+			LOG_INFO("Binary log write failed");
+			return false;
+		}
+	}
+	int64_t after = logWallNanoseconds(logTimeCache());
+
+	BinaryLogReader reader(TEST_BINARYLOG);
+	string text;
+	int64_t previous = before;
+	for (size_t i = 0; i < expected.size(); i++) {
+		if (!reader.next(text) || (text != expected[i])) {
+			LOG_INFO("Binary log event %d decoded as '%s'", (int)i, text.c_str());
+			return false;
+		}
+		if ((reader.getTime() < previous) || (reader.getTime() > after)) {
+			LOG_INFO("Binary log timestamps are out of range");
+			return false;
+		}
+		previous = reader.getTime();
+	}
+	if (reader.next(text) || reader.hasError()) {
+		LOG_INFO("Binary log did not end cleanly");
+		return false;
+	}
+
+	// ids come from the file; a huge one must not size any table
+	{
+		BinaryWriter bw(TEST_BINARYLOGSPARSE, true);
+		bw.forceSetEndian(Little);
+		bw.writeArray((const uint8_t*)"BLOG", 4);
+		bw.write((uint32_t)1);
+		bw.write((unsigned char)FormatRecord);
+		bw.writeVarUInt(0xFFFFFFF0);
+		bw.writeString("sparse %d");
+		bw.writeString("i");
+		bw.write((unsigned char)EventRecord);
+		bw.writeVarUInt(0xFFFFFFF0);
+		bw.writeVarInt(0);
+		bw.writeVarInt(-7);
+	}
+	BinaryLogReader sparse(TEST_BINARYLOGSPARSE);
+	if (!sparse.next(text) || (text != "sparse -7") || sparse.next(text) || sparse.hasError()) {
+		LOG_INFO("Binary log with a sparse format id decoded as '%s'", text.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool testSharedAppend() {
+	// variable length records; every so often one outgrows the buffer
+	auto recordLength = [](int thread, int sequence) {
+		return (sequence % 997 == 0) ? 3000 : (thread * 31 + sequence) % 200;
+	};
+
+	uint64_t expectedSize = 0;
+	{
+		SharedAppendWriter shared(TEST_SHAREDAPPEND, true, 1024);
+		vector<std::thread> threads;
+		for (int t = 0; t < TEST_SHAREDAPPENDTHREADS; t++) {
+			threads.push_back(std::thread([&shared, &recordLength, t] {
+				AppendWriter* writer = shared.createWriter();
+				vector<byte> payload;
+				for (int i = 0; i < TEST_SHAREDAPPENDCOUNT; i++) {
+					payload.assign(recordLength(t, i), (byte)(t * 16 + i));
+					writer->write((uint32_t)t);
+					writer->write((uint32_t)i);
+					writer->writeVarUInt(payload.size());
+					if (!payload.empty()) {
+						writer->write(payload);
+					}
+					writer->endRecord();
+				}
+				delete writer;
+			}));
+			for (int i = 0; i < TEST_SHAREDAPPENDCOUNT; i++) {
+				int length = recordLength(t, i);
+				expectedSize += 8 + ((length < 128) ? 1 : 2) + length;
+			}
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		if (shared.hasError() || (shared.getSize() != expectedSize)) {
+			LOG_INFO("Shared append reserved the wrong number of bytes");
+			return false;
+		}
+	}
+
+	// every record must come back whole, and each thread's in its own order
+	vector<int> next(TEST_SHAREDAPPENDTHREADS, 0);
+	BinaryReader br(TEST_SHAREDAPPEND);
+	vector<byte> payload;
+	while (br.moreData()) {
+		uint32_t t = br.readUInt32();
+		uint32_t i = br.readUInt32();
+		uint64_t length = br.readVarUInt();
+		if (br.hasError() || (t >= TEST_SHAREDAPPENDTHREADS) || ((int)i != next[t]) || ((int)length != recordLength(t, i))) {
+			LOG_INFO("Shared append record header is torn or out of order");
+			return false;
+		}
+		br.readInto(payload, (int)length);
+		if (br.hasError() || (std::count(payload.begin(), payload.end(), (byte)(t * 16 + i)) != (int)length)) {
+			LOG_INFO("Shared append record payload is torn");
+			return false;
+		}
+		next[t]++;
+	}
+	for (int t = 0; t < TEST_SHAREDAPPENDTHREADS; t++) {
+		if (next[t] != TEST_SHAREDAPPENDCOUNT) {
+			LOG_INFO("Shared append lost records of thread %d", t);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool testSyncMarker() {
+	// the search against a plain one, with markers at every alignment
+	byte marker[SYNCMARKER_SIZE];
+	for (int i = 0; i < SYNCMARKER_SIZE; i++) {
+		marker[i] = (byte)(0xA0 + i);
+	}
+	vector<byte> data(300);
+	for (size_t size = 0; size <= data.size(); size += 7) {
+		for (size_t at = 0; at + SYNCMARKER_SIZE <= size + SYNCMARKER_SIZE; at += 5) {
+			for (size_t i = 0; i < data.size(); i++) {
+				// near misses sharing the first and last byte
+				data[i] = (i % 19 == 0) ? marker[0] : ((i % 19 == 15) ? marker[SYNCMARKER_SIZE - 1] : (byte)i);
+			}
+			if (at + SYNCMARKER_SIZE <= size) {
+				memcpy(data.data() + at, marker, SYNCMARKER_SIZE);
+			}
+			size_t expected = size;
+			for (size_t i = 0; i + SYNCMARKER_SIZE <= size; i++) {
+				if (memcmp(data.data() + i, marker, SYNCMARKER_SIZE) == 0) {
+					expected = i;
+					break;
+				}
+			}
+			if (findSyncMarker(data.data(), size, marker) != expected) {
+				LOG_INFO("findSyncMarker missed a marker at %d of %d bytes", (int)at, (int)size);
+				return false;
+			}
+		}
+	}
+
+	return testSyncMarker(1000, 0) && testSyncMarker(0, 7);
+}
+
+bool testSyncMarker(int syncInterval, int recordInterval) {
+	// record i is its index plus a run of i % 300 bytes, and a few are
+	// larger than the buffer
+	auto recordLength = [](int i) {
+		return (i % 1009 == 0) ? 5000 : i % 300;
+	};
+	{
+		SyncMarkerWriter sw(TEST_SYNCMARKER, syncInterval, recordInterval, 1024);
+		vector<byte> payload;
+		for (int i = 0; i < TEST_SYNCMARKERCOUNT; i++) {
+			payload.assign(recordLength(i), (byte)i);
+			sw.writeVarUInt(i);
+			sw.writeVarUInt(payload.size());
+			if (!payload.empty()) {
+				sw.write(payload);
+			}
+			sw.endRecord();
+		}
+		if (sw.hasError()) {
+			LOG_INFO("Sync marker write failed");
+			return false;
+		}
+	}
+
+	ifstream file(TEST_SYNCMARKER, ios::ate | ios::binary);
+	uint64_t fileSize = file.tellg();
+	file.close();
+
+	// uneven ranges, some of them smaller than a block, decoded in parallel;
+	// together they have to yield every record exactly once and in order
+	vector<uint64_t> boundaries = { 0, 3, 5, 6, 700, 701 };
+	for (uint64_t offset = 1500; offset < fileSize; offset += 1500 + offset % 9973) {
+		boundaries.push_back(offset);
+	}
+	boundaries.push_back(fileSize);
+	vector<vector<int>> found(boundaries.size() - 1);
+	vector<char> failed(boundaries.size() - 1, false);
+	vector<std::thread> threads;
+	for (size_t range = 0; range + 1 < boundaries.size(); range++) {
+		threads.push_back(std::thread([&, range] {
+			SyncMarkerReader reader(TEST_SYNCMARKER, 1024);
+			vector<byte> payload;
+			reader.seekToSync(boundaries[range]);
+			while (reader.nextRecord() && (reader.getLastSync() < boundaries[range + 1])) {
+				int index = (int)reader.readVarUInt();
+				int length = (int)reader.readVarUInt();
+				reader.readInto(payload, length);
+				if (reader.hasError() || (length != recordLength(index)) ||
+					(std::count(payload.begin(), payload.end(), (byte)index) != length)) {
+					failed[range] = true;
+					return;
+				}
+				found[range].push_back(index);
+			}
+			failed[range] = failed[range] || reader.hasError();
+		}));
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	int next = 0;
+	for (size_t range = 0; range < found.size(); range++) {
+		if (failed[range]) {
+			LOG_INFO("Range %d decoded a torn record", (int)range);
+			return false;
+		}
+		for (int index : found[range]) {
+			if (index != next) {
+				LOG_INFO("Record %d came back where %d was expected", index, next);
+				return false;
+			}
+			next++;
+		}
+	}
+	if (next != TEST_SYNCMARKERCOUNT) {
+		LOG_INFO("Sync marker ranges lost records after %d", next);
+		return false;
+	}
+
+	return true;
+}
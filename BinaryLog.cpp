@@ -0,0 +1,325 @@
+#include <cstdarg>
+#include <cstring>
+
+#include "BinaryLog.h"
+
+static const char BINARYLOG_MAGIC[4] = { 'B', 'L', 'O', 'G' };
+static const uint32_t BINARYLOG_VERSION = 1;
+
+std::mutex BinaryLogFormats::mutex;
+vector<string> BinaryLogFormats::formats;
+vector<string> BinaryLogFormats::typeLists;
+
+// printf onto the end of text
+static void appendFormatted(string& text, const char* spec, ...) {
+	char piece[256];
+	va_list args, retry;
+	va_start(args, spec);
+	va_copy(retry, args);
+	int length = vsnprintf(piece, sizeof(piece), spec, args);
+	if (length >= (int)sizeof(piece)) {
+		size_t start = text.size();
+		text.resize(start + length + 1);
+		vsnprintf(&text[start], length + 1, spec, retry);
+		text.resize(start + length);
+	} else if (length > 0) {
+		text.append(piece, length);
+	}
+	va_end(retry);
+	va_end(args);
+}
+
+static int64_t asSigned(const BinaryLogValue& value) {
+	switch (value.type) {
+		case 'i':
+			return value.signedValue;
+		case 'f':
+			return (int64_t)value.doubleValue;
+		case 's':
+			return 0;
+		default:
+			return (int64_t)value.unsignedValue;
+	}
+}
+
+static uint64_t asUnsigned(const BinaryLogValue& value) {
+	return (value.type == 'i') ? (uint64_t)value.signedValue : (uint64_t)asSigned(value);
+}
+
+static double asDouble(const BinaryLogValue& value) {
+	switch (value.type) {
+		case 'f':
+			return value.doubleValue;
+		case 'i':
+			return (double)value.signedValue;
+		case 's':
+			return 0;
+		default:
+			return (double)value.unsignedValue;
+	}
+}
+
+uint32_t BinaryLogFormats::add(const char* format, const string& types) {
+	std::lock_guard<std::mutex> lock(mutex);
+	formats.push_back(format);
+	typeLists.push_back(types);
+	return (uint32_t)formats.size() - 1;
+}
+
+bool BinaryLogFormats::get(uint32_t id, string& format, string& types) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (id >= formats.size()) {
+		return false;
+	}
+
+	format = formats[id];
+	types = typeLists[id];
+	return true;
+}
+
+BinaryLogWriter::BinaryLogWriter(const char* fileLocation, int bufferSize) : BinaryLogWriter(string(fileLocation), bufferSize) {
+
+}
+
+BinaryLogWriter::BinaryLogWriter(string fileLocation, int bufferSize) : writer(fileLocation, true, bufferSize) {
+	lastTime = 0;
+	writer.forceSetEndian(Little);
+	for (int i = 0; i < 4; i++) {
+		writer.write(BINARYLOG_MAGIC[i]);
+	}
+	writer.write(BINARYLOG_VERSION);
+}
+
+bool BinaryLogWriter::hasError() {
+	return writer.hasError();
+}
+
+BinaryIOError BinaryLogWriter::getError() {
+	return writer.getError();
+}
+
+BinaryWriter& BinaryLogWriter::getWriter() {
+	return writer;
+}
+
+void BinaryLogWriter::defineFormat(uint32_t formatId) {
+	string format, types;
+	if (!BinaryLogFormats::get(formatId, format, types)) {
+		return;
+	}
+
+	if (formatId >= defined.size()) {
+		defined.resize(formatId + 1, false);
+	}
+	defined[formatId] = true;
+	writer.write((unsigned char)FormatRecord);
+	writer.writeVarUInt(formatId);
+	writer.writeString(format);
+	writer.writeString(types);
+}
+
+BinaryLogReader::BinaryLogReader(const char* fileLocation, int bufferSize) : BinaryLogReader(string(fileLocation), bufferSize) {
+
+}
+
+BinaryLogReader::BinaryLogReader(string fileLocation, int bufferSize) : reader(fileLocation, bufferSize) {
+	time = 0;
+	lastError = reader.getError();
+	reader.forceSetEndian(Little);
+	if (!hasError()) {
+		readHeader();
+	}
+}
+
+bool BinaryLogReader::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError BinaryLogReader::getError() {
+	return lastError;
+}
+
+bool BinaryLogReader::next(string& text) {
+	while (!hasError() && reader.moreData()) {
+		uint8_t record = reader.readUInt8();
+		if (record == FormatRecord) {
+			if (!readFormat()) {
+				return false;
+			}
+			continue;
+		}
+
+		uint64_t id = reader.readVarUInt();
+		int64_t delta = reader.readVarInt();
+		if (reader.hasError()) {
+			lastError = reader.getError();
+			return false;
+		}
+		auto format = formats.find(id);
+		if ((record != EventRecord) || (format == formats.end())) {
+			lastError = InvalidData;
+			return false;
+		}
+
+		time += delta;
+		formatEvent(format->second, text);
+		return !hasError();
+	}
+
+	return false;
+}
+
+int64_t BinaryLogReader::getTime() {
+	return time;
+}
+
+void BinaryLogReader::readHeader() {
+	for (int i = 0; i < 4; i++) {
+		if (reader.readChar() != BINARYLOG_MAGIC[i]) {
+			lastError = reader.hasError() ? reader.getError() : InvalidData;
+			return;
+		}
+	}
+	if (reader.readUInt32() != BINARYLOG_VERSION) {
+		lastError = reader.hasError() ? reader.getError() : InvalidData;
+	}
+}
+
+bool BinaryLogReader::readFormat() {
+	uint64_t id = reader.readVarUInt();
+	string format = reader.readString();
+	string types = reader.readString();
+	if (reader.hasError() || (id > UINT32_MAX) || (types.find_first_not_of("iufsp") != string::npos)) {
+		lastError = reader.hasError() ? reader.getError() : InvalidData;
+		return false;
+	}
+
+	formats[id] = Format { format, types };
+	return true;
+}
+
+void BinaryLogReader::formatEvent(const Format& format, string& text) {
+	// read every argument first; the format string may not use them all
+	values.resize(format.types.size());
+	for (size_t i = 0; i < format.types.size(); i++) {
+		BinaryLogValue& value = values[i];
+		value.type = format.types[i];
+		switch (value.type) {
+			case 'i':
+				value.signedValue = reader.readVarInt();
+				break;
+			case 'f':
+				value.doubleValue = reader.readDouble();
+				break;
+			case 's':
+				reader.readString(value.stringValue);
+				break;
+			default:
+				value.unsignedValue = reader.readVarUInt();
+				break;
+		}
+	}
+	if (reader.hasError()) {
+		lastError = reader.getError();
+		return;
+	}
+
+	text.clear();
+	const char* in = format.format.c_str();
+	size_t next = 0;
+	while (*in != '\0') {
+		if (*in != '%') {
+			const char* plain = strchr(in, '%');
+			size_t length = (plain != NULL) ? (size_t)(plain - in) : strlen(in);
+			text.append(in, length);
+			in += length;
+			continue;
+		}
+		if (in[1] == '%') {
+			text += '%';
+			in += 2;
+			continue;
+		}
+
+		// rebuild the conversion with our own length modifier; '*' widths
+		// and precisions take their value from the argument list
+		const char* start = in;
+		char spec[96];
+		size_t specLength = 0;
+		spec[specLength++] = *in++;
+		while ((*in != '\0') && (strchr("-+ #0", *in) != NULL) && (specLength < 16)) {
+			spec[specLength++] = *in++;
+		}
+		for (int part = 0; part < 2; part++) {
+			if ((part == 1) && (*in == '.')) {
+				spec[specLength++] = *in++;
+			} else if (part == 1) {
+				break;
+			}
+			if ((*in == '*') && (next < values.size())) {
+				specLength += snprintf(spec + specLength, 16, "%d", (int)asSigned(values[next++]));
+				in++;
+			}
+			while ((*in >= '0') && (*in <= '9') && (specLength < 48)) {
+				spec[specLength++] = *in++;
+			}
+		}
+		while ((*in != '\0') && (strchr("hlLqjzt", *in) != NULL)) {
+			in++;
+		}
+
+		char conversion = *in;
+		if ((conversion == '\0') || (next >= values.size())) {
+			// nothing to print it with; keep the text as written
+			text.append(start, (conversion == '\0') ? strlen(start) : (size_t)(in + 1 - start));
+			in += (conversion == '\0') ? 0 : 1;
+			continue;
+		}
+		in++;
+
+		const BinaryLogValue& value = values[next++];
+		switch (conversion) {
+			case 'd':
+			case 'i':
+				memcpy(spec + specLength, "lld", 4);
+				appendFormatted(text, spec, (long long)asSigned(value));
+				break;
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+				memcpy(spec + specLength, "ll", 2);
+				spec[specLength + 2] = conversion;
+				spec[specLength + 3] = '\0';
+				appendFormatted(text, spec, (unsigned long long)asUnsigned(value));
+				break;
+			case 'c':
+				memcpy(spec + specLength, "c", 2);
+				appendFormatted(text, spec, (int)asSigned(value));
+				break;
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				spec[specLength] = conversion;
+				spec[specLength + 1] = '\0';
+				appendFormatted(text, spec, asDouble(value));
+				break;
+			case 's':
+				memcpy(spec + specLength, "s", 2);
+				appendFormatted(text, spec, (value.type == 's') ? value.stringValue.c_str() : "");
+				break;
+			case 'p':
+				memcpy(spec + specLength, "p", 2);
+				appendFormatted(text, spec, (void*)(uintptr_t)asUnsigned(value));
+				break;
+			default:
+				text.append(start, in - start);
+				break;
+		}
+	}
+}
@@ -0,0 +1,178 @@
+#ifndef __BINARYLOG_H__
+#define __BINARYLOG_H__
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "BinaryIO.h"
+#include "Logger.h"
+
+// Deferred format logging. A call site stores the id of its format string
+// and the raw argument values; printf style formatting only happens when
+// the file is decoded with BinaryLogReader.
+//
+//     header: "BLOG", uint32 version (little endian)
+//     format: uint8 FormatRecord, varint id, string format, string types
+//     event:  uint8 EventRecord, varint id, zigzag varint nanoseconds since
+//             the previous event, then one value per argument
+//
+// A format record is written in front of the first event that uses it.
+// Argument types are fixed per call site and travel in the format record
+// as one character each: 'i' signed integer (zigzag varint), 'u' unsigned
+// integer (varint), 'f' double, 's' string, 'p' pointer (varint).
+//
+//     BINARY_LOG(log, "read %d bytes from %s", count, name);
+
+#define BINARY_LOG(log, format, args...)													\
+	do {																					\
+		static const uint32_t _binaryLogFormat = BinaryLogFormats::add(format, decltype(binaryLogSignature(args))::types());	\
+		(log).write(_binaryLogFormat, ## args);											\
+	} while(0)
+
+enum BinaryLogRecord {
+	FormatRecord,
+	EventRecord,
+};
+
+// process wide table of call site formats; ids are handed out in the order
+// call sites first run
+class BinaryLogFormats {
+	public:
+		static uint32_t add(const char* format, const string& types);
+		static bool get(uint32_t id, string& format, string& types);
+
+	private:
+		static std::mutex mutex;
+		static vector<string> formats, typeLists;
+};
+
+template <typename T>
+constexpr char binaryLogType() {
+	typedef typename std::decay<T>::type Arg;
+	if constexpr (std::is_same<Arg, char*>::value || std::is_same<Arg, const char*>::value ||
+			std::is_same<Arg, string>::value || std::is_same<Arg, std::string_view>::value) {
+		return 's';
+	} else if constexpr (std::is_pointer<Arg>::value) {
+		return 'p';
+	} else if constexpr (std::is_floating_point<Arg>::value) {
+		return 'f';
+	} else if constexpr (std::is_signed<Arg>::value || std::is_enum<Arg>::value) {
+		return 'i';
+	} else {
+		static_assert(std::is_integral<Arg>::value, "unsupported binary log argument");
+		return 'u';
+	}
+}
+
+template <typename... Args>
+struct BinaryLogSignature {
+	static string types() {
+		return string { binaryLogType<Args>()... };
+	}
+};
+
+// never defined; BINARY_LOG only names it inside decltype, so working out
+// the argument types does not evaluate the arguments
+template <typename... Args>
+BinaryLogSignature<Args...> binaryLogSignature(const Args&... args);
+
+// one decoded argument; type is the character from the format record
+struct BinaryLogValue {
+	char type;
+	int64_t signedValue;
+	uint64_t unsignedValue;
+	double doubleValue;
+	string stringValue;
+};
+
+// Not thread safe; give every thread its own writer and merge the decoded
+// files by timestamp.
+class BinaryLogWriter {
+	public:
+		BinaryLogWriter(const char* fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		BinaryLogWriter(string fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		bool hasError();
+		BinaryIOError getError();
+		// use BINARY_LOG rather than calling this directly; the arguments
+		// must have the types the format was registered with
+		template <typename... Args>
+		void write(uint32_t formatId, const Args&... args);
+		// the underlying writer, e.g. for enableAsyncFlush
+		BinaryWriter& getWriter();
+
+	private:
+		void defineFormat(uint32_t formatId);
+		template <typename T>
+		void writeArg(const T& value);
+		BinaryWriter writer;
+		vector<bool> defined;
+		int64_t lastTime;
+};
+
+class BinaryLogReader {
+	public:
+		BinaryLogReader(const char* fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		BinaryLogReader(string fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		bool hasError();
+		BinaryIOError getError();
+		// formats the next event into text; false at the end of the file or
+		// on a malformed record
+		bool next(string& text);
+		// nanoseconds since the epoch of the event last returned by next
+		int64_t getTime();
+
+	private:
+		struct Format {
+			string format, types;
+		};
+		void readHeader();
+		bool readFormat();
+		void formatEvent(const Format& format, string& text);
+		BinaryReader reader;
+		// keyed by id; the ids come from the file, so they may be sparse
+		std::unordered_map<uint64_t, Format> formats;
+		vector<BinaryLogValue> values;
+		int64_t time;
+		BinaryIOError lastError;
+};
+
+template <typename... Args>
+void BinaryLogWriter::write(uint32_t formatId, const Args&... args) {
+	if (hasError()) {
+		return;
+	}
+	if ((formatId >= defined.size()) || !defined[formatId]) {
+		defineFormat(formatId);
+	}
+
+	int64_t now = logWallNanoseconds(logTimeCache());
+	writer.write((unsigned char)EventRecord);
+	writer.writeVarUInt(formatId);
+	writer.writeVarInt(now - lastTime);
+	lastTime = now;
+	(writeArg(args), ...);
+}
+
+template <typename T>
+void BinaryLogWriter::writeArg(const T& value) {
+	constexpr char type = binaryLogType<T>();
+	if constexpr ((type == 's') && std::is_pointer<typename std::decay<T>::type>::value) {
+		const char* text = value;
+		writer.writeString((text != NULL) ? std::string_view(text) : std::string_view());
+	} else if constexpr (type == 's') {
+		writer.writeString(value);
+	} else if constexpr (type == 'p') {
+		writer.writeVarUInt((uintptr_t)value);
+	} else if constexpr (type == 'f') {
+		writer.write((double)value);
+	} else if constexpr (type == 'i') {
+		writer.writeVarInt((int64_t)value);
+	} else {
+		writer.writeVarUInt((uint64_t)value);
+	}
+}
+
+#endif // __BINARYLOG_H__
@@ -0,0 +1,158 @@
+#include <cstring>
+
+#include "BlockCodec.h"
+
+BlockCodec::~BlockCodec() {
+
+}
+
+static inline uint32_t read32(const byte* src) {
+	uint32_t value;
+	memcpy(&value, src, 4);
+	return value;
+}
+
+static inline byte* writeLength(byte* dst, size_t length) {
+	while (length >= 255) {
+		*dst++ = 255;
+		length -= 255;
+	}
+	*dst++ = (byte)length;
+	return dst;
+}
+
+static inline bool readLength(const byte*& src, const byte* end, size_t& length) {
+	byte next;
+	do {
+		if (src >= end) {
+			return false;
+		}
+		next = *src++;
+		length += next;
+	} while (next == 255);
+	return true;
+}
+
+uint8_t LzCodec::getId() {
+	return ID;
+}
+
+size_t LzCodec::maxCompressedSize(size_t size) {
+	return size + size / 255 + 16;
+}
+
+size_t LzCodec::compress(const byte* src, size_t size, byte* dst, size_t capacity) {
+	if (capacity < maxCompressedSize(size)) {
+		return 0;
+	}
+
+	// stale entries are harmless; every candidate is verified before use
+	memset(table, 0, sizeof(table));
+	const byte* in = src;
+	const byte* anchor = src;
+	const byte* end = src + size;
+	byte* out = dst;
+
+	while ((size >= MINMATCH) && (in <= end - MINMATCH)) {
+		uint32_t sequence = read32(in);
+		uint32_t hash = (sequence * 2654435761U) >> (32 - HASHBITS);
+		const byte* candidate = src + table[hash];
+		table[hash] = (uint32_t)(in - src);
+
+		if ((candidate >= in) || ((size_t)(in - candidate) > MAXOFFSET) || (read32(candidate) != sequence)) {
+			// step faster through data that keeps failing to match
+			in += 1 + ((in - anchor) >> 6);
+			continue;
+		}
+
+		const byte* matchEnd = in + MINMATCH;
+		const byte* reference = candidate + MINMATCH;
+		while ((matchEnd < end) && (*matchEnd == *reference)) {
+			matchEnd++;
+			reference++;
+		}
+
+		size_t literals = in - anchor;
+		size_t matchLength = (matchEnd - in) - MINMATCH;
+		size_t offset = in - candidate;
+		byte* token = out++;
+		*token = (byte)(((literals < 15) ? literals : 15) << 4);
+		if (literals >= 15) {
+			out = writeLength(out, literals - 15);
+		}
+		memcpy(out, anchor, literals);
+		out += literals;
+		*out++ = (byte)(offset & 0xFF);
+		*out++ = (byte)(offset >> 8);
+		*token |= (byte)((matchLength < 15) ? matchLength : 15);
+		if (matchLength >= 15) {
+			out = writeLength(out, matchLength - 15);
+		}
+
+		in = matchEnd;
+		anchor = in;
+	}
+
+	// the last sequence is literals only
+	size_t literals = end - anchor;
+	*out++ = (byte)(((literals < 15) ? literals : 15) << 4);
+	if (literals >= 15) {
+		out = writeLength(out, literals - 15);
+	}
+	memcpy(out, anchor, literals);
+	out += literals;
+
+	size_t compressed = out - dst;
+	return (compressed < size) ? compressed : 0;
+}
+
+bool LzCodec::decompress(const byte* src, size_t size, byte* dst, size_t rawSize) {
+	const byte* in = src;
+	const byte* inEnd = src + size;
+	byte* out = dst;
+	byte* outEnd = dst + rawSize;
+
+	while (in < inEnd) {
+		byte token = *in++;
+		size_t literals = token >> 4;
+		if ((literals == 15) && !readLength(in, inEnd, literals)) {
+			return false;
+		}
+		if ((literals > (size_t)(inEnd - in)) || (literals > (size_t)(outEnd - out))) {
+			return false;
+		}
+		memcpy(out, in, literals);
+		in += literals;
+		out += literals;
+		if (in == inEnd) {
+			break;
+		}
+
+		if (inEnd - in < 2) {
+			return false;
+		}
+		size_t offset = in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		size_t matchLength = token & 15;
+		if ((matchLength == 15) && !readLength(in, inEnd, matchLength)) {
+			return false;
+		}
+		matchLength += MINMATCH;
+		if ((offset == 0) || (offset > (size_t)(out - dst)) || (matchLength > (size_t)(outEnd - out))) {
+			return false;
+		}
+
+		const byte* match = out - offset;
+		if (offset >= matchLength) {
+			memcpy(out, match, matchLength);
+			out += matchLength;
+		} else {
+			// overlapping copy repeats the last offset bytes
+			for (size_t i = 0; i < matchLength; i++) {
+				*out++ = match[i];
+			}
+		}
+	}
+
+	return (out == outEnd);
+}
@@ -0,0 +1,39 @@
+#ifndef __BLOCKCODEC_H__
+#define __BLOCKCODEC_H__
+
+#include "BinaryIO.h"
+
+// Compression codec for CompressedStream. Every block is compressed on its
+// own, so any block can be decoded without the ones before it. The id is
+// stored in each frame; 0 is reserved for blocks stored uncompressed.
+class BlockCodec {
+	public:
+		virtual ~BlockCodec();
+		virtual uint8_t getId() = 0;
+		virtual size_t maxCompressedSize(size_t size) = 0;
+		// returns the compressed size, or 0 when the block did not shrink
+		virtual size_t compress(const byte* src, size_t size, byte* dst, size_t capacity) = 0;
+		// false when src is not a valid block of exactly rawSize bytes
+		virtual bool decompress(const byte* src, size_t size, byte* dst, size_t rawSize) = 0;
+};
+
+// Byte oriented LZ77 in the style of LZ4: sequences of a token byte (literal
+// length high nibble, match length - 4 low nibble), literals, a 16 bit
+// little endian match offset and length extension bytes. Greedy matching
+// over a single hash table; tuned for speed rather than ratio.
+class LzCodec : public BlockCodec {
+	public:
+		static const uint8_t ID = 1;
+		uint8_t getId();
+		size_t maxCompressedSize(size_t size);
+		size_t compress(const byte* src, size_t size, byte* dst, size_t capacity);
+		bool decompress(const byte* src, size_t size, byte* dst, size_t rawSize);
+
+	private:
+		static const int HASHBITS = 14;
+		static const int MINMATCH = 4;
+		static const size_t MAXOFFSET = 65535;
+		uint32_t table[1 << HASHBITS];
+};
+
+#endif // __BLOCKCODEC_H__
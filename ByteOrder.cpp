@@ -0,0 +1,135 @@
+#include <cstring>
+
+#include "ByteOrder.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BYTEORDER_X86 1
+#include <immintrin.h>
+#endif
+
+enum SwapKernel {
+	SwapScalar,
+	SwapSSSE3,
+	SwapAVX2,
+};
+
+static const uint8_t swapMask2[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+static const uint8_t swapMask4[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+static const uint8_t swapMask8[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+static SwapKernel detectKernel() {
+#ifdef BYTEORDER_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SwapAVX2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		return SwapSSSE3;
+	}
+#endif
+	return SwapScalar;
+}
+
+static SwapKernel swapKernel() {
+	static const SwapKernel kernel = detectKernel();
+	return kernel;
+}
+
+#ifdef BYTEORDER_X86
+// Both kernels return the number of bytes processed; the caller finishes the
+// tail with the scalar loop.
+__attribute__((target("ssse3")))
+static size_t shuffleSSSE3(uint8_t* dst, const uint8_t* src, size_t size, const uint8_t* mask) {
+	const __m128i shuffle = _mm_loadu_si128((const __m128i*)mask);
+	size_t i = 0;
+
+	for (; i + 32 <= size; i += 32) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(a, shuffle));
+		_mm_storeu_si128((__m128i*)(dst + i + 16), _mm_shuffle_epi8(b, shuffle));
+	}
+	for (; i + 16 <= size; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(a, shuffle));
+	}
+
+	return i;
+}
+
+__attribute__((target("avx2")))
+static size_t shuffleAVX2(uint8_t* dst, const uint8_t* src, size_t size, const uint8_t* mask) {
+	const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)mask));
+	size_t i = 0;
+
+	for (; i + 128 <= size; i += 128) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(a, shuffle));
+		_mm256_storeu_si256((__m256i*)(dst + i + 32), _mm256_shuffle_epi8(b, shuffle));
+		_mm256_storeu_si256((__m256i*)(dst + i + 64), _mm256_shuffle_epi8(c, shuffle));
+		_mm256_storeu_si256((__m256i*)(dst + i + 96), _mm256_shuffle_epi8(d, shuffle));
+	}
+	for (; i + 32 <= size; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(a, shuffle));
+	}
+
+	return i;
+}
+#endif
+
+static size_t shuffleSIMD(uint8_t* dst, const uint8_t* src, size_t size, const uint8_t* mask) {
+#ifdef BYTEORDER_X86
+	switch (swapKernel()) {
+		case SwapAVX2:
+			return shuffleAVX2(dst, src, size, mask);
+		case SwapSSSE3:
+			return shuffleSSSE3(dst, src, size, mask);
+		default:
+			break;
+	}
+#endif
+	return 0;
+}
+
+void swapCopy2(void* dst, const void* src, size_t count) {
+	uint8_t* d = (uint8_t*)dst;
+	const uint8_t* s = (const uint8_t*)src;
+	size_t done = shuffleSIMD(d, s, count * 2, swapMask2) / 2;
+
+	for (size_t i = done; i < count; i++) {
+		uint16_t value;
+		memcpy(&value, s + i * 2, 2);
+		value = __builtin_bswap16(value);
+		memcpy(d + i * 2, &value, 2);
+	}
+}
+
+void swapCopy4(void* dst, const void* src, size_t count) {
+	uint8_t* d = (uint8_t*)dst;
+	const uint8_t* s = (const uint8_t*)src;
+	size_t done = shuffleSIMD(d, s, count * 4, swapMask4) / 4;
+
+	for (size_t i = done; i < count; i++) {
+		uint32_t value;
+		memcpy(&value, s + i * 4, 4);
+		value = __builtin_bswap32(value);
+		memcpy(d + i * 4, &value, 4);
+	}
+}
+
+void swapCopy8(void* dst, const void* src, size_t count) {
+	uint8_t* d = (uint8_t*)dst;
+	const uint8_t* s = (const uint8_t*)src;
+	size_t done = shuffleSIMD(d, s, count * 8, swapMask8) / 8;
+
+	for (size_t i = done; i < count; i++) {
+		uint64_t value;
+		memcpy(&value, s + i * 8, 8);
+		value = __builtin_bswap64(value);
+		memcpy(d + i * 8, &value, 8);
+	}
+}
@@ -0,0 +1,28 @@
+#ifndef __BYTEORDER_H__
+#define __BYTEORDER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Single value swaps; these compile to one bswap (or rol for 16 bits).
+static inline uint16_t byteSwap(uint16_t value) {
+	return __builtin_bswap16(value);
+}
+
+static inline uint32_t byteSwap(uint32_t value) {
+	return __builtin_bswap32(value);
+}
+
+static inline uint64_t byteSwap(uint64_t value) {
+	return __builtin_bswap64(value);
+}
+
+// Bulk byte order kernels. Each function copies count elements of the given
+// width from src to dst, reversing the byte order of every element. src and
+// dst may point to the same memory to swap in place, but must not otherwise
+// overlap. SIMD variants are selected at runtime when the CPU supports them.
+void swapCopy2(void* dst, const void* src, size_t count);
+void swapCopy4(void* dst, const void* src, size_t count);
+void swapCopy8(void* dst, const void* src, size_t count);
+
+#endif // __BYTEORDER_H__
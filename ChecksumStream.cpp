@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cstring>
+
+#include "ChecksumStream.h"
+#include "Crc32c.h"
+
+static const uint64_t NO_BLOCK = (uint64_t)-1;
+
+ChecksumStream::ChecksumStream(BinaryIOStream* inner, int blockSize) {
+	this->inner = (inner != NULL) ? inner : new PosixStream();
+	this->blockSize = std::max(blockSize, 1);
+	mode = ios::in;
+	blockDataSize = 0;
+	currentBlock = NO_BLOCK;
+	position = 0;
+	lastError = None;
+}
+
+ChecksumStream::~ChecksumStream() {
+	close();
+	delete inner;
+}
+
+BinaryIOError ChecksumStream::open(const string& fileLocation, ios::openmode mode) {
+	this->mode = mode;
+	block.assign(blockSize + TRAILERSIZE, 0);
+	blockDataSize = 0;
+	currentBlock = NO_BLOCK;
+	position = 0;
+	lastError = None;
+
+	BinaryIOError error = inner->open(fileLocation, mode);
+	if ((error == None) && (mode & ios::app)) {
+		int64_t existing = inner->size();
+		if (existing < 0) {
+			inner->close();
+			return CannotOpenFile;
+		}
+		uint64_t blocks = existing / (blockSize + TRAILERSIZE);
+		position = blocks * blockSize;
+		if (existing % (blockSize + TRAILERSIZE) != 0) {
+			error = reopenLastBlock(fileLocation, blocks * (blockSize + TRAILERSIZE));
+		}
+	}
+
+	return error;
+}
+
+void ChecksumStream::close() {
+	if (inner->isOpen() && (mode & ios::out)) {
+		writeBlock();
+	}
+	inner->close();
+}
+
+bool ChecksumStream::isOpen() {
+	return inner->isOpen();
+}
+
+int64_t ChecksumStream::read(char* dst, size_t count) {
+	if (mode & ios::out) {
+		return -1;
+	}
+
+	uint64_t index = position / blockSize;
+	if ((index != currentBlock) && !loadBlock(index)) {
+		return (lastError != None) ? -1 : 0;
+	}
+
+	size_t offset = position % blockSize;
+	if (offset >= blockDataSize) {
+		return 0;
+	}
+	size_t chunk = std::min(count, blockDataSize - offset);
+	memcpy(dst, block.data() + offset, chunk);
+	position += chunk;
+	return chunk;
+}
+
+int64_t ChecksumStream::write(const char* src, size_t count) {
+	if (!(mode & ios::out)) {
+		return -1;
+	}
+
+	size_t written = 0;
+	while (written < count) {
+		size_t chunk = std::min(count - written, (size_t)blockSize - blockDataSize);
+		memcpy(block.data() + blockDataSize, src + written, chunk);
+		blockDataSize += chunk;
+		written += chunk;
+		if ((blockDataSize == (size_t)blockSize) && !writeBlock()) {
+			return -1;
+		}
+	}
+
+	position += count;
+	return count;
+}
+
+int64_t ChecksumStream::readAt(char* dst, size_t count, uint64_t offset) {
+	uint64_t saved = position;
+	position = offset;
+
+	size_t copied = 0;
+	while (copied < count) {
+		int64_t chunk = read(dst + copied, count - copied);
+		if (chunk < 0) {
+			position = saved;
+			return -1;
+		}
+		if (chunk == 0) {
+			break;
+		}
+		copied += chunk;
+	}
+
+	position = saved;
+	return copied;
+}
+
+int64_t ChecksumStream::writeAt(const char*, size_t, uint64_t) {
+	return -1;
+}
+
+bool ChecksumStream::seek(uint64_t offset) {
+	if (mode & ios::out) {
+		return false;
+	}
+
+	// the block is loaded, and checked, by the next read
+	position = offset;
+	return true;
+}
+
+int64_t ChecksumStream::tell() {
+	return position;
+}
+
+int64_t ChecksumStream::size() {
+	if (mode & ios::out) {
+		return position;
+	}
+
+	int64_t stored = inner->size();
+	if (stored < 0) {
+		return -1;
+	}
+	int64_t blocks = stored / (blockSize + TRAILERSIZE);
+	int64_t tail = stored % (blockSize + TRAILERSIZE);
+	return blocks * blockSize + std::max(tail - TRAILERSIZE, (int64_t)0);
+}
+
+bool ChecksumStream::sync() {
+	return inner->sync();
+}
+
+bool ChecksumStream::advise(BinaryIOAdvice advice, uint64_t, uint64_t) {
+	return inner->advise(advice);
+}
+
+BinaryIOError ChecksumStream::getError() {
+	return (lastError != None) ? lastError : inner->getError();
+}
+
+// Appends always go to the end of the file, so the partial block could not
+// be replaced in append mode. The file is reopened for reading and writing
+// instead and positioned at the start of that block; the block only grows
+// when written again, so no stale bytes are left past the new end.
+BinaryIOError ChecksumStream::reopenLastBlock(const string& fileLocation, uint64_t blockOffset) {
+	inner->close();
+	BinaryIOError error = inner->open(fileLocation, (mode & ~ios::app) | ios::in);
+	if (error != None) {
+		return error;
+	}
+
+	int64_t loaded = inner->readAt((char*)block.data(), block.size(), blockOffset);
+	if ((loaded <= TRAILERSIZE) || (loaded >= (int64_t)block.size())) {
+		inner->close();
+		return (loaded < 0) ? GenericReadError : ChecksumMismatch;
+	}
+	size_t dataSize = loaded - TRAILERSIZE;
+	if (crc32c(0, block.data(), dataSize) != BitConverter::getUInt32(block.data() + dataSize, Little)) {
+		inner->close();
+		return ChecksumMismatch;
+	}
+	if (!inner->seek(blockOffset)) {
+		inner->close();
+		return CannotOpenFile;
+	}
+
+	blockDataSize = dataSize;
+	position += dataSize;
+	return None;
+}
+
+bool ChecksumStream::writeBlock() {
+	if (blockDataSize == 0) {
+		return true;
+	}
+
+	uint32_t crc = crc32c(0, block.data(), blockDataSize);
+	BitConverter::getBytes(crc, block.data() + blockDataSize, Little);
+	size_t size = blockDataSize + TRAILERSIZE;
+	blockDataSize = 0;
+
+	return (inner->write((const char*)block.data(), size) == (int64_t)size);
+}
+
+bool ChecksumStream::loadBlock(uint64_t index) {
+	currentBlock = NO_BLOCK;
+	blockDataSize = 0;
+	lastError = None;
+
+	uint64_t fileOffset = index * (blockSize + TRAILERSIZE);
+	size_t loaded = 0;
+	while (loaded < block.size()) {
+		int64_t chunk = inner->readAt((char*)block.data() + loaded, block.size() - loaded, fileOffset + loaded);
+		if (chunk < 0) {
+			lastError = GenericReadError;
+			return false;
+		}
+		if (chunk == 0) {
+			break;
+		}
+		loaded += chunk;
+	}
+	if (loaded == 0) {
+		// past the last block
+		return false;
+	}
+	if (loaded <= TRAILERSIZE) {
+		lastError = ChecksumMismatch;
+		return false;
+	}
+
+	size_t dataSize = loaded - TRAILERSIZE;
+	if (crc32c(0, block.data(), dataSize) != BitConverter::getUInt32(block.data() + dataSize, Little)) {
+		lastError = ChecksumMismatch;
+		return false;
+	}
+
+	blockDataSize = dataSize;
+	currentBlock = index;
+	return true;
+}
@@ -0,0 +1,55 @@
+#ifndef __CHECKSUMSTREAM_H__
+#define __CHECKSUMSTREAM_H__
+
+#include "BinaryIOStream.h"
+
+// Integrity layer between a reader or writer and another stream. Data is
+// cut into blocks of blockSize bytes, each followed by a 4 byte little
+// endian CRC32C trailer; only the last block may be short. Every block is
+// verified as it is loaded, and a bad one fails the read with
+// ChecksumMismatch. Block positions are fixed, so seeks need no index.
+//
+// A partial block is only written on close(); sync() persists whole blocks.
+// Appending to a file whose last block is partial verifies that block and
+// writes it out again in place, extended by the new bytes; the inner stream
+// must then support reading and writing at once.
+class ChecksumStream : public BinaryIOStream {
+	public:
+		static const int DEFAULT_BLOCKSIZE = 65536;
+		static const int TRAILERSIZE = 4;
+		// takes ownership of inner; NULL picks PosixStream
+		ChecksumStream(BinaryIOStream* inner = NULL, int blockSize = DEFAULT_BLOCKSIZE);
+		~ChecksumStream();
+		// owns inner
+		ChecksumStream(const ChecksumStream&) = delete;
+		ChecksumStream& operator=(const ChecksumStream&) = delete;
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		bool sync();
+		bool advise(BinaryIOAdvice advice, uint64_t offset = 0, uint64_t length = 0);
+		BinaryIOError getError();
+
+	private:
+		BinaryIOError reopenLastBlock(const string& fileLocation, uint64_t blockOffset);
+		bool writeBlock();
+		bool loadBlock(uint64_t index);
+		BinaryIOStream* inner;
+		int blockSize;
+		ios::openmode mode;
+		// block data plus room for its trailer
+		vector<byte> block;
+		size_t blockDataSize;
+		uint64_t currentBlock;
+		uint64_t position;
+		BinaryIOError lastError;
+};
+
+#endif // __CHECKSUMSTREAM_H__
@@ -0,0 +1,365 @@
+#include <algorithm>
+
+#include "ColumnarBinaryIO.h"
+
+static const char COLUMNAR_MAGIC[4] = { 'B', 'C', 'O', 'L' };
+static const uint32_t COLUMNAR_VERSION = 1;
+
+int columnTypeSize(ColumnType type) {
+	switch (type) {
+		case Int8Column:
+		case UInt8Column:
+			return 1;
+		case Int16Column:
+		case UInt16Column:
+			return 2;
+		case Int32Column:
+		case UInt32Column:
+		case FloatColumn:
+			return 4;
+		case Int64Column:
+		case UInt64Column:
+		case DoubleColumn:
+		default:
+			return 8;
+	}
+}
+
+ColumnarBinaryWriter::ColumnarBinaryWriter(const char* fileLocation, int blockRows, int bufferSize) : ColumnarBinaryWriter(string(fileLocation), blockRows, bufferSize) {
+
+}
+
+ColumnarBinaryWriter::ColumnarBinaryWriter(string fileLocation, int blockRows, int bufferSize) : writer(fileLocation, true, bufferSize) {
+	this->blockRows = std::max(blockRows, 1);
+	rows = 0;
+	fileEndian = endian;
+	headerWritten = false;
+	lastError = writer.getError();
+}
+
+ColumnarBinaryWriter::~ColumnarBinaryWriter() {
+	flushBlock();
+	if (!headerWritten) {
+		writeHeader();
+	}
+}
+
+bool ColumnarBinaryWriter::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError ColumnarBinaryWriter::getError() {
+	return lastError;
+}
+
+void ColumnarBinaryWriter::forceSetEndian(Endian newEndian) {
+	if (headerWritten || (rows > 0)) {
+		lastError = InvalidData;
+		return;
+	}
+	fileEndian = newEndian;
+}
+
+int ColumnarBinaryWriter::addColumn(ColumnType type) {
+	if (headerWritten || (rows > 0)) {
+		lastError = InvalidData;
+		return -1;
+	}
+
+	types.push_back(type);
+	columns.push_back(vector<byte>());
+	columns.back().reserve((size_t)blockRows * columnTypeSize(type));
+	return (int)types.size() - 1;
+}
+
+void ColumnarBinaryWriter::write(int column, float value) {
+	append(column, FloatColumn, value);
+}
+
+void ColumnarBinaryWriter::write(int column, double value) {
+	append(column, DoubleColumn, value);
+}
+
+void ColumnarBinaryWriter::write(int column, int8_t value) {
+	append(column, Int8Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, int16_t value) {
+	append(column, Int16Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, int32_t value) {
+	append(column, Int32Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, int64_t value) {
+	append(column, Int64Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, uint8_t value) {
+	append(column, UInt8Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, uint16_t value) {
+	append(column, UInt16Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, uint32_t value) {
+	append(column, UInt32Column, value);
+}
+
+void ColumnarBinaryWriter::write(int column, uint64_t value) {
+	append(column, UInt64Column, value);
+}
+
+void ColumnarBinaryWriter::endRow() {
+	if (hasError()) {
+		return;
+	}
+
+	rows++;
+	for (size_t i = 0; i < columns.size(); i++) {
+		if (columns[i].size() != (size_t)rows * columnTypeSize(types[i])) {
+			lastError = InvalidData;
+			return;
+		}
+	}
+
+	if (rows >= blockRows) {
+		flushBlock();
+	}
+}
+
+void ColumnarBinaryWriter::flushBlock() {
+	if (hasError() || (rows == 0)) {
+		return;
+	}
+	if (!headerWritten) {
+		writeHeader();
+	}
+
+	writer.write((uint32_t)rows);
+	for (size_t i = 0; i < columns.size(); i++) {
+		writer.write((uint64_t)columns[i].size());
+	}
+
+	// values are kept in host order; writeArray swaps them in bulk when the
+	// file order differs
+	for (size_t i = 0; i < columns.size(); i++) {
+		const byte* data = columns[i].data();
+		switch (types[i]) {
+			case Int8Column:
+				writer.writeArray((const int8_t*)data, rows);
+				break;
+			case Int16Column:
+				writer.writeArray((const int16_t*)data, rows);
+				break;
+			case Int32Column:
+				writer.writeArray((const int32_t*)data, rows);
+				break;
+			case Int64Column:
+				writer.writeArray((const int64_t*)data, rows);
+				break;
+			case UInt8Column:
+				writer.writeArray((const uint8_t*)data, rows);
+				break;
+			case UInt16Column:
+				writer.writeArray((const uint16_t*)data, rows);
+				break;
+			case UInt32Column:
+				writer.writeArray((const uint32_t*)data, rows);
+				break;
+			case UInt64Column:
+				writer.writeArray((const uint64_t*)data, rows);
+				break;
+			case FloatColumn:
+				writer.writeArray((const float*)data, rows);
+				break;
+			case DoubleColumn:
+				writer.writeArray((const double*)data, rows);
+				break;
+		}
+		columns[i].clear();
+	}
+
+	rows = 0;
+	lastError = writer.getError();
+}
+
+template <typename T>
+void ColumnarBinaryWriter::append(int column, ColumnType type, T value) {
+	if (hasError()) {
+		return;
+	}
+	if ((column < 0) || (column >= (int)types.size()) || (types[column] != type)) {
+		lastError = InvalidData;
+		return;
+	}
+
+	const byte* bytes = (const byte*)&value;
+	columns[column].insert(columns[column].end(), bytes, bytes + sizeof(T));
+}
+
+void ColumnarBinaryWriter::writeHeader() {
+	writer.forceSetEndian(fileEndian);
+	for (int i = 0; i < 4; i++) {
+		writer.write(COLUMNAR_MAGIC[i]);
+	}
+	writer.write((uint8_t)((fileEndian == Little) ? 1 : 0));
+	writer.write(COLUMNAR_VERSION);
+	writer.write((uint32_t)types.size());
+	for (size_t i = 0; i < types.size(); i++) {
+		writer.write((uint8_t)types[i]);
+	}
+
+	headerWritten = true;
+	lastError = writer.getError();
+}
+
+ColumnarBinaryReader::ColumnarBinaryReader(const char* fileLocation, int bufferSize) : ColumnarBinaryReader(string(fileLocation), bufferSize) {
+
+}
+
+ColumnarBinaryReader::ColumnarBinaryReader(string fileLocation, int bufferSize) : reader(fileLocation, bufferSize) {
+	blockRows = 0;
+	nextBlockOffset = 0;
+	lastError = reader.getError();
+	if (!hasError()) {
+		readHeader();
+	}
+}
+
+bool ColumnarBinaryReader::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError ColumnarBinaryReader::getError() {
+	return lastError;
+}
+
+int ColumnarBinaryReader::getColumnCount() {
+	return (int)types.size();
+}
+
+ColumnType ColumnarBinaryReader::getColumnType(int column) {
+	return types[column];
+}
+
+bool ColumnarBinaryReader::nextBlock() {
+	blockRows = 0;
+	if (hasError() || !reader.seek(nextBlockOffset) || !reader.moreData()) {
+		lastError = reader.getError();
+		return false;
+	}
+
+	uint32_t rows = reader.readUInt32();
+	uint64_t offset = nextBlockOffset + 4 + 8 * types.size();
+	for (size_t i = 0; i < types.size(); i++) {
+		uint64_t length = reader.readUInt64();
+		if (length != (uint64_t)rows * columnTypeSize(types[i])) {
+			lastError = InvalidData;
+			return false;
+		}
+		columnOffsets[i] = offset;
+		offset += length;
+	}
+	if (reader.hasError()) {
+		lastError = reader.getError();
+		return false;
+	}
+
+	blockRows = (int)rows;
+	nextBlockOffset = offset;
+	return true;
+}
+
+int ColumnarBinaryReader::getBlockRows() {
+	return blockRows;
+}
+
+void ColumnarBinaryReader::readColumn(int column, float* values) {
+	fetch(column, FloatColumn, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, double* values) {
+	fetch(column, DoubleColumn, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, int8_t* values) {
+	fetch(column, Int8Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, int16_t* values) {
+	fetch(column, Int16Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, int32_t* values) {
+	fetch(column, Int32Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, int64_t* values) {
+	fetch(column, Int64Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, uint8_t* values) {
+	fetch(column, UInt8Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, uint16_t* values) {
+	fetch(column, UInt16Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, uint32_t* values) {
+	fetch(column, UInt32Column, values);
+}
+
+void ColumnarBinaryReader::readColumn(int column, uint64_t* values) {
+	fetch(column, UInt64Column, values);
+}
+
+template <typename T>
+void ColumnarBinaryReader::fetch(int column, ColumnType type, T* values) {
+	if (hasError() || (blockRows == 0)) {
+		return;
+	}
+	if ((column < 0) || (column >= (int)types.size()) || (types[column] != type)) {
+		lastError = InvalidData;
+		return;
+	}
+
+	// a column next to the last one read is usually still buffered; any
+	// other is a single seek, so skipped columns are never read
+	if (reader.seek(columnOffsets[column])) {
+		reader.readArray(values, blockRows);
+	}
+	lastError = reader.getError();
+}
+
+void ColumnarBinaryReader::readHeader() {
+	for (int i = 0; i < 4; i++) {
+		if (reader.readChar() != COLUMNAR_MAGIC[i]) {
+			lastError = reader.hasError() ? reader.getError() : InvalidData;
+			return;
+		}
+	}
+	reader.forceSetEndian((reader.readUInt8() != 0) ? Little : Big);
+	uint32_t version = reader.readUInt32();
+	uint32_t columnCount = reader.readUInt32();
+	if (reader.hasError() || (version != COLUMNAR_VERSION)) {
+		lastError = reader.hasError() ? reader.getError() : InvalidData;
+		return;
+	}
+
+	for (uint32_t i = 0; i < columnCount; i++) {
+		uint8_t type = reader.readUInt8();
+		if (type > DoubleColumn) {
+			lastError = InvalidData;
+			return;
+		}
+		types.push_back((ColumnType)type);
+	}
+	columnOffsets.resize(columnCount);
+
+	nextBlockOffset = reader.tell();
+	lastError = reader.getError();
+}
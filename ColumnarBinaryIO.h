@@ -0,0 +1,107 @@
+#ifndef __COLUMNARBINARYIO_H__
+#define __COLUMNARBINARYIO_H__
+
+#include "BinaryIO.h"
+
+enum ColumnType {
+	Int8Column,
+	Int16Column,
+	Int32Column,
+	Int64Column,
+	UInt8Column,
+	UInt16Column,
+	UInt32Column,
+	UInt64Column,
+	FloatColumn,
+	DoubleColumn,
+};
+
+int columnTypeSize(ColumnType type);
+
+// Column oriented file layout:
+//
+//     header: "BCOL", uint8 byte order (0 big, 1 little), uint32 version,
+//             uint32 column count, one uint8 ColumnType per column
+//     block:  uint32 row count, one uint64 byte length per column, then
+//             every column as one contiguous typed run
+//
+// Rows are collected in memory and written a block at a time. The per
+// column lengths let a reader step over columns it does not need.
+class ColumnarBinaryWriter {
+	public:
+		static const int DEFAULT_BLOCKROWS = 65536;
+		ColumnarBinaryWriter(const char* fileLocation, int blockRows = DEFAULT_BLOCKROWS, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		ColumnarBinaryWriter(string fileLocation, int blockRows = DEFAULT_BLOCKROWS, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		~ColumnarBinaryWriter();
+		bool hasError();
+		BinaryIOError getError();
+		// must be called before the first row is written
+		void forceSetEndian(Endian endian);
+		int addColumn(ColumnType type);
+		// one value per column and row; a value whose type does not match
+		// its column sets InvalidData
+		void write(int column, float value);
+		void write(int column, double value);
+		void write(int column, int8_t value);
+		void write(int column, int16_t value);
+		void write(int column, int32_t value);
+		void write(int column, int64_t value);
+		void write(int column, uint8_t value);
+		void write(int column, uint16_t value);
+		void write(int column, uint32_t value);
+		void write(int column, uint64_t value);
+		void endRow();
+		// writes the rows collected so far as a block
+		void flushBlock();
+
+	private:
+		template <typename T>
+		void append(int column, ColumnType type, T value);
+		void writeHeader();
+		BinaryWriter writer;
+		Endian fileEndian;
+		vector<ColumnType> types;
+		vector<vector<byte>> columns;
+		int blockRows, rows;
+		bool headerWritten;
+		BinaryIOError lastError;
+};
+
+class ColumnarBinaryReader {
+	public:
+		ColumnarBinaryReader(const char* fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		ColumnarBinaryReader(string fileLocation, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		bool hasError();
+		BinaryIOError getError();
+		int getColumnCount();
+		ColumnType getColumnType(int column);
+		// moves to the next block; false once there are no more
+		bool nextBlock();
+		int getBlockRows();
+		// fetches one column of the current block into values, which must
+		// hold getBlockRows() elements; columns may be read in any order
+		// and columns that are never read are never fetched
+		void readColumn(int column, float* values);
+		void readColumn(int column, double* values);
+		void readColumn(int column, int8_t* values);
+		void readColumn(int column, int16_t* values);
+		void readColumn(int column, int32_t* values);
+		void readColumn(int column, int64_t* values);
+		void readColumn(int column, uint8_t* values);
+		void readColumn(int column, uint16_t* values);
+		void readColumn(int column, uint32_t* values);
+		void readColumn(int column, uint64_t* values);
+
+	private:
+		template <typename T>
+		void fetch(int column, ColumnType type, T* values);
+		void readHeader();
+		BinaryReader reader;
+		vector<ColumnType> types;
+		vector<uint64_t> columnOffsets;
+		int blockRows;
+		uint64_t nextBlockOffset;
+		BinaryIOError lastError;
+};
+
+#endif // __COLUMNARBINARYIO_H__
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cstring>
+
+#include "CompressedStream.h"
+
+static const size_t NO_FRAME = (size_t)-1;
+// a frame failed to load; reads fail until the next successful seek
+static const size_t BAD_FRAME = (size_t)-2;
+
+CompressedStream::CompressedStream(BinaryIOStream* inner, BlockCodec* codec, int blockSize) {
+	this->inner = (inner != NULL) ? inner : new PosixStream();
+	this->codec = (codec != NULL) ? codec : new LzCodec();
+	this->blockSize = std::max(blockSize, 1);
+	mode = ios::in;
+	blockPos = 0;
+	currentFrame = NO_FRAME;
+	indexedEnd = 0;
+	indexedFileEnd = 0;
+	indexComplete = false;
+	rawWritten = 0;
+}
+
+CompressedStream::~CompressedStream() {
+	close();
+	delete inner;
+	delete codec;
+}
+
+BinaryIOError CompressedStream::open(const string& fileLocation, ios::openmode mode) {
+	this->mode = mode;
+	block.clear();
+	blockPos = 0;
+	frames.clear();
+	currentFrame = NO_FRAME;
+	indexedEnd = 0;
+	indexedFileEnd = 0;
+	indexComplete = false;
+	rawWritten = 0;
+	if (mode & ios::out) {
+		block.reserve(blockSize);
+	}
+
+	return inner->open(fileLocation, mode);
+}
+
+void CompressedStream::close() {
+	if (inner->isOpen() && (mode & ios::out)) {
+		writeFrame();
+	}
+	inner->close();
+}
+
+bool CompressedStream::isOpen() {
+	return inner->isOpen();
+}
+
+int64_t CompressedStream::read(char* dst, size_t count) {
+	if ((mode & ios::out) || (currentFrame == BAD_FRAME)) {
+		return -1;
+	}
+
+	if (blockPos >= block.size()) {
+		size_t next = (currentFrame == NO_FRAME) ? 0 : (currentFrame + 1);
+		uint64_t nextOffset = (currentFrame == NO_FRAME) ? 0 : (frames[currentFrame].rawOffset + block.size());
+		if (!indexFrames(nextOffset)) {
+			return -1;
+		}
+		if (next >= frames.size()) {
+			return 0;
+		}
+		if (!loadFrame(next)) {
+			return -1;
+		}
+	}
+
+	size_t chunk = std::min(count, block.size() - blockPos);
+	memcpy(dst, block.data() + blockPos, chunk);
+	blockPos += chunk;
+	return chunk;
+}
+
+int64_t CompressedStream::write(const char* src, size_t count) {
+	if (!(mode & ios::out)) {
+		return -1;
+	}
+
+	size_t written = 0;
+	while (written < count) {
+		size_t chunk = std::min(count - written, (size_t)blockSize - block.size());
+		block.insert(block.end(), (const byte*)src + written, (const byte*)src + written + chunk);
+		written += chunk;
+		if ((block.size() >= (size_t)blockSize) && !writeFrame()) {
+			return -1;
+		}
+	}
+
+	rawWritten += count;
+	return count;
+}
+
+int64_t CompressedStream::readAt(char* dst, size_t count, uint64_t offset) {
+	// frames only decode whole, so go through the cursor and put it back
+	int64_t position = tell();
+	if ((position < 0) || !seek(offset)) {
+		return -1;
+	}
+
+	size_t copied = 0;
+	while (copied < count) {
+		int64_t chunk = read(dst + copied, count - copied);
+		if (chunk < 0) {
+			seek(position);
+			return -1;
+		}
+		if (chunk == 0) {
+			break;
+		}
+		copied += chunk;
+	}
+
+	seek(position);
+	return copied;
+}
+
+int64_t CompressedStream::writeAt(const char*, size_t, uint64_t) {
+	return -1;
+}
+
+bool CompressedStream::seek(uint64_t offset) {
+	if ((mode & ios::out) || !indexFrames(offset)) {
+		return false;
+	}
+	if (frames.empty()) {
+		return (offset == 0);
+	}
+
+	// last frame starting at or before offset
+	size_t index = frames.size() - 1;
+	if (offset < indexedEnd) {
+		size_t low = 0;
+		size_t high = frames.size();
+		while (high - low > 1) {
+			size_t middle = (low + high) / 2;
+			if (frames[middle].rawOffset <= offset) {
+				low = middle;
+			} else {
+				high = middle;
+			}
+		}
+		index = low;
+	}
+
+	if ((index != currentFrame) && !loadFrame(index)) {
+		return false;
+	}
+	// past the end leaves the cursor at the end of the last frame
+	blockPos = (size_t)std::min(offset - frames[index].rawOffset, (uint64_t)block.size());
+	return true;
+}
+
+int64_t CompressedStream::tell() {
+	if (mode & ios::out) {
+		return rawWritten;
+	}
+	if (currentFrame == NO_FRAME) {
+		return 0;
+	}
+	if (currentFrame == BAD_FRAME) {
+		return -1;
+	}
+
+	return frames[currentFrame].rawOffset + blockPos;
+}
+
+int64_t CompressedStream::size() {
+	if (mode & ios::out) {
+		return rawWritten;
+	}
+	if (!indexFrames(UINT64_MAX)) {
+		return -1;
+	}
+
+	return indexedEnd;
+}
+
+bool CompressedStream::sync() {
+	if ((mode & ios::out) && !writeFrame()) {
+		return false;
+	}
+
+	return inner->sync();
+}
+
+bool CompressedStream::advise(BinaryIOAdvice advice, uint64_t, uint64_t) {
+	// raw offsets mean nothing to the inner stream, so hint the whole file
+	return inner->advise(advice);
+}
+
+bool CompressedStream::writeFrame() {
+	if (block.empty()) {
+		return true;
+	}
+
+	size_t rawSize = block.size();
+	frame.resize(FRAME_HEADERSIZE + codec->maxCompressedSize(rawSize));
+	byte* payload = frame.data() + FRAME_HEADERSIZE;
+	size_t storedSize = codec->compress(block.data(), rawSize, payload, frame.size() - FRAME_HEADERSIZE);
+	uint8_t id = codec->getId();
+	if (storedSize == 0) {
+		// incompressible; storing it costs only the header
+		memcpy(payload, block.data(), rawSize);
+		storedSize = rawSize;
+		id = 0;
+	}
+
+	frame[0] = id;
+	BitConverter::getBytes((uint32_t)rawSize, frame.data() + 1, Little);
+	BitConverter::getBytes((uint32_t)storedSize, frame.data() + 5, Little);
+	block.clear();
+
+	return (inner->write((const char*)frame.data(), FRAME_HEADERSIZE + storedSize) == (int64_t)(FRAME_HEADERSIZE + storedSize));
+}
+
+bool CompressedStream::loadFrame(size_t index) {
+	// stays marked bad unless the whole frame decodes
+	currentFrame = BAD_FRAME;
+	block.clear();
+	blockPos = 0;
+
+	uint64_t fileOffset = frames[index].fileOffset;
+	byte header[FRAME_HEADERSIZE];
+	if (inner->readAt((char*)header, FRAME_HEADERSIZE, fileOffset) != FRAME_HEADERSIZE) {
+		return false;
+	}
+	uint8_t id = header[0];
+	uint32_t rawSize = BitConverter::getUInt32(header + 1, Little);
+	uint32_t storedSize = BitConverter::getUInt32(header + 5, Little);
+
+	frame.resize(storedSize);
+	size_t loaded = 0;
+	while (loaded < storedSize) {
+		int64_t chunk = inner->readAt((char*)frame.data() + loaded, storedSize - loaded, fileOffset + FRAME_HEADERSIZE + loaded);
+		if (chunk <= 0) {
+			return false;
+		}
+		loaded += chunk;
+	}
+
+	if ((id == 0) && (storedSize != rawSize)) {
+		return false;
+	}
+	block.resize(rawSize);
+	if (id == 0) {
+		memcpy(block.data(), frame.data(), rawSize);
+	} else if ((id != codec->getId()) || !codec->decompress(frame.data(), storedSize, block.data(), rawSize)) {
+		block.clear();
+		return false;
+	}
+
+	currentFrame = index;
+	return true;
+}
+
+// Reads frame headers until the frame holding rawOffset is known or the file
+// ends. Only headers are touched, so indexing a whole file is cheap.
+bool CompressedStream::indexFrames(uint64_t rawOffset) {
+	while (!indexComplete && (indexedEnd <= rawOffset)) {
+		byte header[FRAME_HEADERSIZE];
+		int64_t ret = inner->readAt((char*)header, FRAME_HEADERSIZE, indexedFileEnd);
+		if (ret == 0) {
+			indexComplete = true;
+			break;
+		}
+		uint32_t rawSize = BitConverter::getUInt32(header + 1, Little);
+		if ((ret != FRAME_HEADERSIZE) || (rawSize == 0)) {
+			return false;
+		}
+
+		frames.push_back(Frame { indexedEnd, indexedFileEnd });
+		indexedEnd += rawSize;
+		indexedFileEnd += FRAME_HEADERSIZE + BitConverter::getUInt32(header + 5, Little);
+	}
+
+	return true;
+}
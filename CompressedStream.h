@@ -0,0 +1,68 @@
+#ifndef __COMPRESSEDSTREAM_H__
+#define __COMPRESSEDSTREAM_H__
+
+#include "BinaryIOStream.h"
+#include "BlockCodec.h"
+
+// Compression layer between a reader or writer and another stream. Written
+// bytes are collected into blocks of blockSize, and each block goes out as
+// an independent frame:
+//
+//     uint8 codec id (0 stored), uint32 raw size, uint32 stored size,
+//     stored size bytes of payload (all integers little endian)
+//
+// Reads decode one frame at a time. Offsets seen through this stream are
+// uncompressed offsets; seeking walks the frame headers once and then jumps
+// straight to the frame holding the target. Positional writes are not
+// supported.
+class CompressedStream : public BinaryIOStream {
+	public:
+		static const int DEFAULT_BLOCKSIZE = 65536;
+		static const int FRAME_HEADERSIZE = 9;
+		// takes ownership of inner and codec; NULL picks PosixStream and
+		// LzCodec
+		CompressedStream(BinaryIOStream* inner = NULL, BlockCodec* codec = NULL, int blockSize = DEFAULT_BLOCKSIZE);
+		~CompressedStream();
+		// owns inner, codec and the block buffers
+		CompressedStream(const CompressedStream&) = delete;
+		CompressedStream& operator=(const CompressedStream&) = delete;
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		// writes out the partial block before syncing the inner stream
+		bool sync();
+		bool advise(BinaryIOAdvice advice, uint64_t offset = 0, uint64_t length = 0);
+
+	private:
+		struct Frame {
+			uint64_t rawOffset;
+			uint64_t fileOffset;
+		};
+		bool writeFrame();
+		bool loadFrame(size_t index);
+		bool indexFrames(uint64_t rawOffset);
+		BinaryIOStream* inner;
+		BlockCodec* codec;
+		int blockSize;
+		ios::openmode mode;
+		// staged raw bytes when writing, the decoded frame when reading
+		vector<byte> block;
+		vector<byte> frame;
+		size_t blockPos;
+		// read side frame index, filled in as frames are discovered
+		vector<Frame> frames;
+		size_t currentFrame;
+		// raw and file offsets just past the last indexed frame
+		uint64_t indexedEnd, indexedFileEnd;
+		bool indexComplete;
+		uint64_t rawWritten;
+};
+
+#endif // __COMPRESSEDSTREAM_H__
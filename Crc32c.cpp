@@ -0,0 +1,95 @@
+#include <cstring>
+
+#include "Crc32c.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRC32C_X86 1
+#include <immintrin.h>
+#endif
+
+static const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+struct Crc32cTables {
+	uint32_t table[8][256];
+};
+
+static Crc32cTables buildTables() {
+	Crc32cTables tables;
+	for (int i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
+		}
+		tables.table[0][i] = crc;
+	}
+	for (int i = 0; i < 256; i++) {
+		for (int k = 1; k < 8; k++) {
+			tables.table[k][i] = (tables.table[k - 1][i] >> 8) ^ tables.table[0][tables.table[k - 1][i] & 0xFF];
+		}
+	}
+	return tables;
+}
+
+static uint32_t crc32cSoftware(uint32_t crc, const uint8_t* data, size_t size) {
+	static const Crc32cTables tables = buildTables();
+	const uint32_t (*t)[256] = tables.table;
+
+	while ((size >= 8) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) {
+		uint32_t low, high;
+		memcpy(&low, data, 4);
+		memcpy(&high, data + 4, 4);
+		low ^= crc;
+		crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+			t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+		data += 8;
+		size -= 8;
+	}
+	while (size > 0) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+		data++;
+		size--;
+	}
+
+	return crc;
+}
+
+#ifdef CRC32C_X86
+static bool hasSSE42() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.2");
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32cSSE42(uint32_t crc, const uint8_t* data, size_t size) {
+#ifdef __x86_64__
+	uint64_t crc64 = crc;
+	while (size >= 8) {
+		uint64_t value;
+		memcpy(&value, data, 8);
+		crc64 = _mm_crc32_u64(crc64, value);
+		data += 8;
+		size -= 8;
+	}
+	crc = (uint32_t)crc64;
+#endif
+	while (size > 0) {
+		crc = _mm_crc32_u8(crc, *data);
+		data++;
+		size--;
+	}
+
+	return crc;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	crc = ~crc;
+#ifdef CRC32C_X86
+	static const bool hardware = hasSSE42();
+	if (hardware) {
+		return ~crc32cSSE42(crc, bytes, size);
+	}
+#endif
+	return ~crc32cSoftware(crc, bytes, size);
+}
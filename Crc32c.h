@@ -0,0 +1,13 @@
+#ifndef __CRC32C_H__
+#define __CRC32C_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli). crc is the value returned by a previous call, or 0 to
+// start; feeding a buffer in pieces gives the same result as all at once.
+// Uses the SSE4.2 crc32 instruction when the CPU has it, and a slicing by 8
+// table walk otherwise.
+uint32_t crc32c(uint32_t crc, const void* data, size_t size);
+
+#endif // __CRC32C_H__
@@ -0,0 +1,221 @@
+#ifndef __ENDIANBINARYIO_H__
+#define __ENDIANBINARYIO_H__
+
+#include "BinaryIO.h"
+#include "ByteOrder.h"
+
+// Reader and writer with the file byte order fixed at compile time. Multi
+// byte values are moved with a single unaligned load or store while the
+// buffer has room, plus one bswap when the order differs from the host.
+// The runtime forceSetEndian() switch is not available on these classes.
+template <Endian E>
+class EndianBinaryReader : public BinaryReader {
+	public:
+		EndianBinaryReader(const char* fileLocation, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		EndianBinaryReader(string fileLocation, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		float readFloat();
+		double readDouble();
+		int16_t readInt16();
+		int32_t readInt32();
+		int64_t readInt64();
+		uint16_t readUInt16();
+		uint32_t readUInt32();
+		uint64_t readUInt64();
+
+	private:
+		using BinaryIOBase::forceSetEndian;
+		using BinaryIOBase::forceUnsetEndian;
+		template <typename T>
+		T load();
+};
+
+template <Endian E>
+class EndianBinaryWriter : public BinaryWriter {
+	public:
+		EndianBinaryWriter(const char* fileLocation, bool overwrite = false, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		EndianBinaryWriter(string fileLocation, bool overwrite = false, int bufferSize = DEFAULT_BUFFERSIZE, int bufferAlignment = 0, BinaryIOBackend backend = DefaultBackend);
+		using BinaryWriter::write;
+		void write(float value);
+		void write(double value);
+		void write(int16_t value);
+		void write(int32_t value);
+		void write(int64_t value);
+		void write(uint16_t value);
+		void write(uint32_t value);
+		void write(uint64_t value);
+
+	private:
+		using BinaryIOBase::forceSetEndian;
+		using BinaryIOBase::forceUnsetEndian;
+		template <typename T>
+		void store(T value);
+};
+
+typedef EndianBinaryReader<Little> LittleEndianBinaryReader;
+typedef EndianBinaryReader<Big> BigEndianBinaryReader;
+typedef EndianBinaryWriter<Little> LittleEndianBinaryWriter;
+typedef EndianBinaryWriter<Big> BigEndianBinaryWriter;
+
+template <Endian E>
+EndianBinaryReader<E>::EndianBinaryReader(const char* fileLocation, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryReader(fileLocation, bufferSize, bufferAlignment, backend) {
+	// keeps the inherited bulk and byte paths in agreement with E
+	BinaryIOBase::forceSetEndian(E);
+}
+
+template <Endian E>
+EndianBinaryReader<E>::EndianBinaryReader(string fileLocation, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryReader(fileLocation, bufferSize, bufferAlignment, backend) {
+	BinaryIOBase::forceSetEndian(E);
+}
+
+template <Endian E>
+template <typename T>
+inline T EndianBinaryReader<E>::load() {
+	T value;
+	if ((lastError == None) && (bufferDataSize - bufferPos >= (int)sizeof(T))) {
+		memcpy(&value, buffer + bufferPos, sizeof(T));
+		bufferPos += sizeof(T);
+	} else if (hasError() || (readRaw(&value, sizeof(T)) != sizeof(T))) {
+		return 0;
+	}
+
+	if (E != endian) {
+		value = byteSwap(value);
+	}
+	return value;
+}
+
+template <Endian E>
+inline float EndianBinaryReader<E>::readFloat() {
+	stats.values[FloatValue]++;
+	float value;
+	uint32_t valueBytes = load<uint32_t>();
+	memcpy(&value, &valueBytes, 4);
+	return value;
+}
+
+template <Endian E>
+inline double EndianBinaryReader<E>::readDouble() {
+	stats.values[DoubleValue]++;
+	double value;
+	uint64_t valueBytes = load<uint64_t>();
+	memcpy(&value, &valueBytes, 8);
+	return value;
+}
+
+template <Endian E>
+inline int16_t EndianBinaryReader<E>::readInt16() {
+	stats.values[Int16Value]++;
+	return (int16_t)load<uint16_t>();
+}
+
+template <Endian E>
+inline int32_t EndianBinaryReader<E>::readInt32() {
+	stats.values[Int32Value]++;
+	return (int32_t)load<uint32_t>();
+}
+
+template <Endian E>
+inline int64_t EndianBinaryReader<E>::readInt64() {
+	stats.values[Int64Value]++;
+	return (int64_t)load<uint64_t>();
+}
+
+template <Endian E>
+inline uint16_t EndianBinaryReader<E>::readUInt16() {
+	stats.values[UInt16Value]++;
+	return load<uint16_t>();
+}
+
+template <Endian E>
+inline uint32_t EndianBinaryReader<E>::readUInt32() {
+	stats.values[UInt32Value]++;
+	return load<uint32_t>();
+}
+
+template <Endian E>
+inline uint64_t EndianBinaryReader<E>::readUInt64() {
+	stats.values[UInt64Value]++;
+	return load<uint64_t>();
+}
+
+template <Endian E>
+EndianBinaryWriter<E>::EndianBinaryWriter(const char* fileLocation, bool overwrite, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryWriter(fileLocation, overwrite, bufferSize, bufferAlignment, backend) {
+	BinaryIOBase::forceSetEndian(E);
+}
+
+template <Endian E>
+EndianBinaryWriter<E>::EndianBinaryWriter(string fileLocation, bool overwrite, int bufferSize, int bufferAlignment, BinaryIOBackend backend) : BinaryWriter(fileLocation, overwrite, bufferSize, bufferAlignment, backend) {
+	BinaryIOBase::forceSetEndian(E);
+}
+
+template <Endian E>
+template <typename T>
+inline void EndianBinaryWriter<E>::store(T value) {
+	if (E != endian) {
+		value = byteSwap(value);
+	}
+
+	if (bufferSize - bufferPos < (int)sizeof(T)) {
+		flush();
+	}
+	if (hasError()) {
+		return;
+	}
+
+	memcpy(buffer + bufferPos, &value, sizeof(T));
+	bufferPos += sizeof(T);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(float value) {
+	stats.values[FloatValue]++;
+	uint32_t valueBytes;
+	memcpy(&valueBytes, &value, 4);
+	store(valueBytes);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(double value) {
+	stats.values[DoubleValue]++;
+	uint64_t valueBytes;
+	memcpy(&valueBytes, &value, 8);
+	store(valueBytes);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(int16_t value) {
+	stats.values[Int16Value]++;
+	store((uint16_t)value);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(int32_t value) {
+	stats.values[Int32Value]++;
+	store((uint32_t)value);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(int64_t value) {
+	stats.values[Int64Value]++;
+	store((uint64_t)value);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(uint16_t value) {
+	stats.values[UInt16Value]++;
+	store(value);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(uint32_t value) {
+	stats.values[UInt32Value]++;
+	store(value);
+}
+
+template <Endian E>
+inline void EndianBinaryWriter<E>::write(uint64_t value) {
+	stats.values[UInt64Value]++;
+	store(value);
+}
+
+#endif // __ENDIANBINARYIO_H__
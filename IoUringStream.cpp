@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+#define IOURING_AVAILABLE 1
+#include <linux/io_uring.h>
+#else
+struct io_uring_sqe;
+struct io_uring_cqe;
+#endif
+
+#include "IoUringStream.h"
+
+enum SlotState {
+	SlotIdle,
+	SlotPending,
+	SlotReady,
+};
+
+struct ReadSlot {
+	char* data;
+	uint64_t offset;
+	size_t filled;
+	size_t consumed;
+	int64_t result;
+	SlotState state;
+	struct iovec iov;
+};
+
+struct IoUringRing {
+	int ringFd;
+	void* sqPtr;
+	void* cqPtr;
+	size_t sqSize, cqSize;
+	struct io_uring_sqe* sqes;
+	size_t sqesSize;
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned* sqMask;
+	unsigned* sqArray;
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned* cqMask;
+	struct io_uring_cqe* cqes;
+	ReadSlot* slots;
+	int pending;
+};
+
+#ifdef IOURING_AVAILABLE
+static IoUringRing* createRing(int entries) {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	int ringFd = syscall(__NR_io_uring_setup, entries, &params);
+	if (ringFd < 0) {
+		return NULL;
+	}
+
+	IoUringRing* ring = new IoUringRing();
+	ring->ringFd = ringFd;
+	ring->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP);
+	if (singleMap) {
+		ring->sqSize = ring->cqSize = std::max(ring->sqSize, ring->cqSize);
+	}
+
+	ring->sqPtr = mmap(NULL, ring->sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	ring->cqPtr = ring->sqPtr;
+	if (!singleMap && (ring->sqPtr != MAP_FAILED)) {
+		ring->cqPtr = mmap(NULL, ring->cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+	}
+	ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+
+	if ((ring->sqPtr == MAP_FAILED) || (ring->cqPtr == MAP_FAILED) || (ring->sqes == MAP_FAILED)) {
+		if (ring->sqes != MAP_FAILED) {
+			munmap(ring->sqes, ring->sqesSize);
+		}
+		if (!singleMap && (ring->cqPtr != MAP_FAILED)) {
+			munmap(ring->cqPtr, ring->cqSize);
+		}
+		if (ring->sqPtr != MAP_FAILED) {
+			munmap(ring->sqPtr, ring->sqSize);
+		}
+		::close(ringFd);
+		delete ring;
+		return NULL;
+	}
+
+	char* sq = (char*)ring->sqPtr;
+	char* cq = (char*)ring->cqPtr;
+	ring->sqHead = (unsigned*)(sq + params.sq_off.head);
+	ring->sqTail = (unsigned*)(sq + params.sq_off.tail);
+	ring->sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+	ring->sqArray = (unsigned*)(sq + params.sq_off.array);
+	ring->cqHead = (unsigned*)(cq + params.cq_off.head);
+	ring->cqTail = (unsigned*)(cq + params.cq_off.tail);
+	ring->cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+	ring->slots = NULL;
+	ring->pending = 0;
+
+	return ring;
+}
+
+static void destroyRing(IoUringRing* ring) {
+	munmap(ring->sqes, ring->sqesSize);
+	if (ring->cqPtr != ring->sqPtr) {
+		munmap(ring->cqPtr, ring->cqSize);
+	}
+	munmap(ring->sqPtr, ring->sqSize);
+	::close(ring->ringFd);
+	delete ring;
+}
+#endif
+
+IoUringStream::IoUringStream(int queueDepth, int blockSize) {
+	this->queueDepth = std::max(queueDepth, 1);
+	this->blockSize = std::max(blockSize, 4096);
+	ring = NULL;
+	currentSlot = 0;
+	position = 0;
+	nextOffset = 0;
+}
+
+IoUringStream::~IoUringStream() {
+	close();
+}
+
+BinaryIOError IoUringStream::open(const string& fileLocation, ios::openmode mode) {
+	BinaryIOError error = PosixStream::open(fileLocation, mode);
+	if ((error != None) || (mode & ios::out)) {
+		return error;
+	}
+
+#ifdef IOURING_AVAILABLE
+	ring = createRing(queueDepth);
+	if (ring == NULL) {
+		// no io_uring here; PosixStream::read takes over
+		return None;
+	}
+
+	ring->slots = new ReadSlot[queueDepth]();
+	for (int i = 0; i < queueDepth; i++) {
+		void* memory = NULL;
+		if (posix_memalign(&memory, 4096, blockSize) != 0) {
+			memory = NULL;
+		}
+		ring->slots[i].data = (char*)memory;
+		ring->slots[i].state = SlotIdle;
+		if (memory == NULL) {
+			close();
+			return CannotOpenFile;
+		}
+	}
+
+	startReadAhead(0);
+#endif
+
+	return None;
+}
+
+void IoUringStream::close() {
+#ifdef IOURING_AVAILABLE
+	if (ring != NULL) {
+		drain();
+		if (ring->slots != NULL) {
+			for (int i = 0; i < queueDepth; i++) {
+				free(ring->slots[i].data);
+			}
+			delete[] ring->slots;
+		}
+		destroyRing(ring);
+		ring = NULL;
+	}
+#endif
+	PosixStream::close();
+}
+
+bool IoUringStream::isAsync() {
+	return (ring != NULL);
+}
+
+int64_t IoUringStream::read(char* dst, size_t count) {
+	if (ring == NULL) {
+		return PosixStream::read(dst, count);
+	}
+
+	while (true) {
+		ReadSlot& slot = ring->slots[currentSlot];
+		while (slot.state == SlotPending) {
+			if (!waitForCompletion()) {
+				return -1;
+			}
+		}
+		if (slot.result < 0) {
+			return -1;
+		}
+
+		if (slot.consumed < slot.filled) {
+			size_t chunk = std::min(count, slot.filled - slot.consumed);
+			memcpy(dst, slot.data + slot.consumed, chunk);
+			slot.consumed += chunk;
+			position += chunk;
+			return chunk;
+		}
+		if (slot.filled < (size_t)blockSize) {
+			// a short block only happens at the end of the file
+			return 0;
+		}
+
+		// block used up; recycle it for the next block past the window
+		slot.offset = nextOffset;
+		nextOffset += blockSize;
+		submit(currentSlot);
+		currentSlot = (currentSlot + 1) % queueDepth;
+	}
+}
+
+bool IoUringStream::seek(uint64_t offset) {
+	if (ring == NULL) {
+		return PosixStream::seek(offset);
+	}
+
+	drain();
+	startReadAhead(offset);
+	return true;
+}
+
+int64_t IoUringStream::tell() {
+	if (ring == NULL) {
+		return PosixStream::tell();
+	}
+
+	return position;
+}
+
+void IoUringStream::startReadAhead(uint64_t offset) {
+	position = offset;
+	nextOffset = offset;
+	currentSlot = 0;
+	for (int i = 0; i < queueDepth; i++) {
+		ring->slots[i].offset = nextOffset;
+		nextOffset += blockSize;
+		submit(i);
+	}
+}
+
+void IoUringStream::submit(int slotIndex) {
+#ifdef IOURING_AVAILABLE
+	ReadSlot& slot = ring->slots[slotIndex];
+	if (slot.state != SlotPending) {
+		slot.filled = 0;
+		slot.consumed = 0;
+		slot.result = 0;
+		slot.state = SlotPending;
+		ring->pending++;
+	}
+	// resubmissions after a short read continue where the last one stopped
+	slot.iov.iov_base = slot.data + slot.filled;
+	slot.iov.iov_len = blockSize - slot.filled;
+
+	unsigned tail = *ring->sqTail;
+	unsigned index = tail & *ring->sqMask;
+	struct io_uring_sqe* sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)&slot.iov;
+	sqe->len = 1;
+	sqe->off = slot.offset + slot.filled;
+	sqe->user_data = slotIndex;
+	ring->sqArray[index] = index;
+	__atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+	int ret;
+	do {
+		ret = syscall(__NR_io_uring_enter, ring->ringFd, 1, 0, 0, NULL, 0);
+	} while ((ret < 0) && (errno == EINTR));
+	if (ret < 0) {
+		slot.result = -1;
+		slot.state = SlotReady;
+		ring->pending--;
+	}
+#endif
+}
+
+bool IoUringStream::waitForCompletion() {
+#ifdef IOURING_AVAILABLE
+	unsigned head = *ring->cqHead;
+	if (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+		int ret = syscall(__NR_io_uring_enter, ring->ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if ((ret < 0) && (errno != EINTR)) {
+			return false;
+		}
+	}
+
+	while (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+		struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cqMask];
+		int slotIndex = (int)cqe->user_data;
+		int res = cqe->res;
+		ReadSlot& slot = ring->slots[slotIndex];
+		head++;
+		__atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+		if (res > 0) {
+			slot.filled += res;
+			if (slot.filled < (size_t)blockSize) {
+				// short read; ask for the rest, a zero result marks the end
+				submit(slotIndex);
+				continue;
+			}
+		} else if (res < 0) {
+			slot.result = res;
+		}
+		slot.state = SlotReady;
+		ring->pending--;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void IoUringStream::drain() {
+	// buffers may not be reused or freed while the kernel still owns them
+	while (ring->pending > 0) {
+		if (!waitForCompletion()) {
+			break;
+		}
+	}
+}
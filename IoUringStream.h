@@ -0,0 +1,37 @@
+#ifndef __IOURINGSTREAM_H__
+#define __IOURINGSTREAM_H__
+
+#include "BinaryIOStream.h"
+
+struct IoUringRing;
+
+// Read-ahead backend for BinaryReader. Opened for reading, it keeps
+// queueDepth reads of blockSize bytes in flight through io_uring ahead of
+// the consumer, so refills usually find their data already resident.
+// Everything else, and the whole stream when io_uring is unavailable or
+// the file is opened for writing, falls back to PosixStream.
+class IoUringStream : public PosixStream {
+	public:
+		static const int DEFAULT_QUEUEDEPTH = 8;
+		static const int DEFAULT_BLOCKSIZE = 131072;
+		IoUringStream(int queueDepth = DEFAULT_QUEUEDEPTH, int blockSize = DEFAULT_BLOCKSIZE);
+		~IoUringStream();
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		int64_t read(char* dst, size_t count);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		bool isAsync();
+
+	private:
+		void startReadAhead(uint64_t offset);
+		void submit(int slot);
+		bool waitForCompletion();
+		void drain();
+		int queueDepth, blockSize;
+		IoUringRing* ring;
+		int currentSlot;
+		uint64_t position, nextOffset;
+};
+
+#endif // __IOURINGSTREAM_H__
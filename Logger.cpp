@@ -1,10 +1,17 @@
 #include <cstdarg>
+#include <cstdlib>
 #include <fstream>
 
+#include "AsyncLog.h"
 #include "Logger.h"
 
 Logger* Logger::instance = NULL;
 
+// lines still in the ring when main returns would otherwise be lost
+static void drainAtExit() {
+	Logger::Instance()->disableAsync();
+}
+
 Logger::~Logger() {
 	if (instance != NULL) {
 		instance->closeLogFile();
@@ -36,6 +43,9 @@ void Logger::openLogFile(const char* fileName, bool trunc) {
 }
 
 void Logger::closeLogFile() {
+	if (async != NULL) {
+		async->drain();
+	}
 	if (logFile) {
 		fflush(logFile);
 		fclose(logFile);
@@ -47,8 +57,50 @@ void Logger::log(const char* fmt, ...) {
 	if ((logFile != NULL) && logFile) {
 		va_list args;
 		va_start(args, fmt);
-		vfprintf(logFile, fmt, args);
+		if (async != NULL) {
+			async->append(logFile, fmt, args);
+		} else {
+			vfprintf(logFile, fmt, args);
+			fflush(logFile);
+		}
 		va_end(args);
-		fflush(logFile);
 	}
 }
+
+void Logger::echo(FILE* stream, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	if (async != NULL) {
+		async->append(stream, fmt, args);
+	} else {
+		vfprintf(stream, fmt, args);
+	}
+	va_end(args);
+}
+
+void Logger::enableAsync(int capacity, int flushInterval, LogOverflowPolicy policy) {
+	static bool exitHandler = false;
+	if (async != NULL) {
+		return;
+	}
+
+	if (!exitHandler) {
+		atexit(drainAtExit);
+		exitHandler = true;
+	}
+	async = new AsyncLog(capacity, flushInterval, policy);
+}
+
+void Logger::disableAsync() {
+	if (async == NULL) {
+		return;
+	}
+
+	droppedBefore += async->getDropped();
+	delete async;
+	async = NULL;
+}
+
+uint64_t Logger::getDroppedCount() {
+	return droppedBefore + ((async != NULL) ? async->getDropped() : 0);
+}
@@ -1,24 +1,49 @@
 #ifndef LOGGER_H_
 #define LOGGER_H_
 
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 
 static inline char* currentTime();
+static inline char* currentTimePrecise();
+
+// what an asynchronous Logger does with a line when its ring is full
+enum LogOverflowPolicy {
+	BlockOnOverflow,
+	DropOnOverflow,
+};
+
+class AsyncLog;
 
 class Logger {
 	public:
 		~Logger();
 		static Logger* Instance();
 		void openLogFile(const char* fileName, bool trunc = false);
+		// drains pending asynchronous lines before the file is closed
 		void closeLogFile();
 		void log(const char* fmt, ...);
+		// console side of the LOG_ macros
+		void echo(FILE* stream, const char* fmt, ...);
+		// callers only format into a lock-free ring of capacity lines and a
+		// background thread writes them out in batches, at least every
+		// flushInterval milliseconds. Pending lines are also written on
+		// disableAsync, closeLogFile and process exit. Switch modes while
+		// no other thread is logging
+		void enableAsync(int capacity = 4096, int flushInterval = 100, LogOverflowPolicy policy = BlockOnOverflow);
+		void disableAsync();
+		// lines lost to DropOnOverflow
+		uint64_t getDroppedCount();
 
 	private:
 		static Logger* instance;
 		FILE* logFile;
-		Logger() { logFile = NULL; };
+		AsyncLog* async;
+		uint64_t droppedBefore;
+		Logger() { logFile = NULL; async = NULL; droppedBefore = 0; };
 		Logger(Logger const&) { };
 		Logger& operator=(Logger const&) { };
 };
@@ -28,7 +53,11 @@ class Logger {
 #define _FILE strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__
 #define LOG_FILE	"Logger.log"
 #define LOG_FMT		"%s | %-5s | %s:%d | "
+#if LOG_SUBSECOND
+#define LOG_ARGS(LOG_TAG) currentTimePrecise(), LOG_TAG, _FILE, __LINE__
+#else
 #define LOG_ARGS(LOG_TAG) currentTime(), LOG_TAG, _FILE, __LINE__
+#endif
 #define INDENT_FMT	"%*s"
 
 #if DEBUG
@@ -43,7 +72,7 @@ class Logger {
 #define LOG_INFO_INDENT(indent, message, args...)										\
 	do {																				\
 		Logger::Instance()->log(LOG_FMT message NEWLINE, LOG_ARGS("INFO"), ## args);	\
-		fprintf(stdout, INDENT_FMT message NEWLINE, (indent * 4), "", ## args);			\
+		Logger::Instance()->echo(stdout, INDENT_FMT message NEWLINE, (indent * 4), "", ## args);	\
 	} while(0)
 
 #define LOG_INFO(message, args...) LOG_INFO_INDENT(0, message, ## args)
@@ -51,22 +80,73 @@ class Logger {
 #define LOG_ERROR_INDENT(indent, message, args...)										\
 	do {																				\
 		Logger::Instance()->log(LOG_FMT message NEWLINE, LOG_ARGS("ERROR"), ## args);	\
-		fprintf(stderr, INDENT_FMT message NEWLINE, (indent * 4), "", ## args);			\
+		Logger::Instance()->echo(stderr, INDENT_FMT message NEWLINE, (indent * 4), "", ## args);	\
 	} while(0)
 
 #define LOG_ERROR(message, args...) LOG_ERROR_INDENT(0, message, ## args)
 
-static inline char *currentTime() {
-	static char buffer[64];
-	time_t rawTime;
-	struct tm *timeInfo;
+// Per thread timestamp state. The wall clock is read once per anchor
+// period and extended with the monotonic clock in between, and the
+// date and time text is only rebuilt when the second changes
+#define LOGTIME_ANCHOR_NS 60000000000LL
 
-	time(&rawTime);
-	timeInfo = localtime(&rawTime);
+struct LogTimeCache {
+	int64_t anchorWall, anchorSteady;
+	int64_t second;
+	char text[32];
+};
 
-	strftime(buffer, 64, "%Y-%m-%d %H:%M:%S", timeInfo);
+static inline LogTimeCache& logTimeCache() {
+	static thread_local LogTimeCache cache = { 0, 0, -1, { } };
+	return cache;
+}
+
+// nanoseconds since the epoch; only goes backwards when a new anchor
+// catches up with a wall clock that was stepped
+static inline int64_t logWallNanoseconds(LogTimeCache& cache) {
+	using namespace std::chrono;
+	int64_t steady = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	if ((cache.second < 0) || (steady - cache.anchorSteady >= LOGTIME_ANCHOR_NS)) {
+		cache.anchorWall = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+		cache.anchorSteady = steady;
+	}
+	return cache.anchorWall + (steady - cache.anchorSteady);
+}
+
+// returns the cached "YYYY-mm-dd HH:MM:SS" text, formatted anew when the
+// second changed
+static inline char* logTimeText(LogTimeCache& cache, int64_t wall) {
+	time_t second = (time_t)(wall / 1000000000LL);
+	if (second != cache.second) {
+		struct tm timeInfo;
+		localtime_r(&second, &timeInfo);
+		strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &timeInfo);
+		cache.second = second;
+	}
+	return cache.text;
+}
+
+static inline char *currentTime() {
+	LogTimeCache& cache = logTimeCache();
+	char* text = logTimeText(cache, logWallNanoseconds(cache));
+	text[19] = '\0';
+	return text;
+}
 
-	return buffer;
+// currentTime with microseconds appended, "YYYY-mm-dd HH:MM:SS.uuuuuu";
+// selected for the LOG_ macros by defining LOG_SUBSECOND
+static inline char* currentTimePrecise() {
+	LogTimeCache& cache = logTimeCache();
+	int64_t wall = logWallNanoseconds(cache);
+	char* text = logTimeText(cache, wall);
+	int micros = (int)((wall % 1000000000LL) / 1000);
+	text[19] = '.';
+	for (int i = 25; i > 19; i--) {
+		text[i] = (char)('0' + micros % 10);
+		micros /= 10;
+	}
+	text[26] = '\0';
+	return text;
 }
 
 #endif // LOGGER_H_
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ByteOrder.h"
+#include "MappedBinaryReader.h"
+
+MappedBinaryReader::MappedBinaryReader(const char* fileLocation) : fileLocation(fileLocation) {
+	open();
+}
+
+MappedBinaryReader::MappedBinaryReader(string fileLocation) : fileLocation(fileLocation) {
+	open();
+}
+
+MappedBinaryReader::~MappedBinaryReader() {
+	if (data != NULL) {
+		munmap((void*)data, dataSize);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+void MappedBinaryReader::open() {
+	fd = -1;
+	data = NULL;
+	dataSize = 0;
+	position = 0;
+	pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	lastError = None;
+	forceEndian = false;
+	endianOverride = endian;
+
+	fd = ::open(fileLocation.c_str(), O_RDONLY);
+	if (fd < 0) {
+		lastError = (errno == ENOENT) ? FileDoesNotExist : CannotOpenFile;
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		lastError = CannotOpenFile;
+		return;
+	}
+
+	dataSize = (uint64_t)info.st_size;
+	if (dataSize == 0) {
+		// mmap rejects empty mappings; an empty file simply has no data
+		return;
+	}
+
+	void* mapping = mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapping == MAP_FAILED) {
+		dataSize = 0;
+		lastError = GenericReadError;
+		return;
+	}
+	data = (const byte*)mapping;
+
+	adviseSequential();
+}
+
+bool MappedBinaryReader::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError MappedBinaryReader::getError() {
+	return lastError;
+}
+
+void MappedBinaryReader::forceSetEndian(Endian newEndian) {
+	forceEndian = true;
+	endianOverride = newEndian;
+}
+
+void MappedBinaryReader::forceUnsetEndian() {
+	forceEndian = false;
+	endianOverride = endian;
+}
+
+bool MappedBinaryReader::isLittleEndian() {
+	return (!forceEndian ? endian : endianOverride);
+}
+
+Endian MappedBinaryReader::fileEndian() {
+	return (isLittleEndian() ? Little : Big);
+}
+
+bool MappedBinaryReader::moreData() {
+	return (position < dataSize);
+}
+
+uint64_t MappedBinaryReader::getSize() {
+	return dataSize;
+}
+
+uint64_t MappedBinaryReader::getPosition() {
+	return position;
+}
+
+bool MappedBinaryReader::readBool() {
+	const byte* bytes = take(1);
+	return ((bytes != NULL) ? BitConverter::getBool(bytes, fileEndian()) : false);
+}
+
+byte MappedBinaryReader::readByte() {
+	const byte* bytes = take(1);
+	return ((bytes != NULL) ? bytes[0] : 0);
+}
+
+char MappedBinaryReader::readChar() {
+	return (char)readByte();
+}
+
+signed char MappedBinaryReader::readSChar() {
+	return (signed char)readByte();
+}
+
+unsigned char MappedBinaryReader::readUChar() {
+	return (unsigned char)readByte();
+}
+
+float MappedBinaryReader::readFloat() {
+	const byte* bytes = take(4);
+	return ((bytes != NULL) ? BitConverter::getFloat(bytes, fileEndian()) : 0.0f);
+}
+
+double MappedBinaryReader::readDouble() {
+	const byte* bytes = take(8);
+	return ((bytes != NULL) ? BitConverter::getDouble(bytes, fileEndian()) : 0.0);
+}
+
+int8_t MappedBinaryReader::readInt8() {
+	return (int8_t)readByte();
+}
+
+int16_t MappedBinaryReader::readInt16() {
+	return (int16_t)readUInt16();
+}
+
+int32_t MappedBinaryReader::readInt32() {
+	return (int32_t)readUInt32();
+}
+
+int64_t MappedBinaryReader::readInt64() {
+	return (int64_t)readUInt64();
+}
+
+uint8_t MappedBinaryReader::readUInt8() {
+	return readByte();
+}
+
+uint16_t MappedBinaryReader::readUInt16() {
+	const byte* bytes = take(2);
+	return ((bytes != NULL) ? BitConverter::getUInt16(bytes, fileEndian()) : 0U);
+}
+
+uint32_t MappedBinaryReader::readUInt32() {
+	const byte* bytes = take(4);
+	return ((bytes != NULL) ? BitConverter::getUInt32(bytes, fileEndian()) : 0U);
+}
+
+uint64_t MappedBinaryReader::readUInt64() {
+	const byte* bytes = take(8);
+	return ((bytes != NULL) ? BitConverter::getUInt64(bytes, fileEndian()) : 0U);
+}
+
+vector<byte> MappedBinaryReader::readBytes(int count) {
+	if (count <= 0) {
+		return vector<byte>(0);
+	}
+
+	const byte* bytes = take(count);
+	if (bytes == NULL) {
+		return vector<byte>(0);
+	}
+
+	return vector<byte>(bytes, bytes + count);
+}
+
+void MappedBinaryReader::readArray(float* values, int count) {
+	readArrayN(values, count, 4);
+}
+
+void MappedBinaryReader::readArray(double* values, int count) {
+	readArrayN(values, count, 8);
+}
+
+void MappedBinaryReader::readArray(int8_t* values, int count) {
+	readArrayN(values, count, 1);
+}
+
+void MappedBinaryReader::readArray(int16_t* values, int count) {
+	readArrayN(values, count, 2);
+}
+
+void MappedBinaryReader::readArray(int32_t* values, int count) {
+	readArrayN(values, count, 4);
+}
+
+void MappedBinaryReader::readArray(int64_t* values, int count) {
+	readArrayN(values, count, 8);
+}
+
+void MappedBinaryReader::readArray(uint8_t* values, int count) {
+	readArrayN(values, count, 1);
+}
+
+void MappedBinaryReader::readArray(uint16_t* values, int count) {
+	readArrayN(values, count, 2);
+}
+
+void MappedBinaryReader::readArray(uint32_t* values, int count) {
+	readArrayN(values, count, 4);
+}
+
+void MappedBinaryReader::readArray(uint64_t* values, int count) {
+	readArrayN(values, count, 8);
+}
+
+ByteView MappedBinaryReader::readView(size_t count) {
+	const byte* bytes = take(count);
+	if (bytes == NULL) {
+		return ByteView { NULL, 0 };
+	}
+
+	return ByteView { bytes, count };
+}
+
+ByteView MappedBinaryReader::view(uint64_t offset, size_t count) {
+	if ((offset > dataSize) || (count > dataSize - offset)) {
+		lastError = NotEnoughData;
+		return ByteView { NULL, 0 };
+	}
+
+	return ByteView { data + offset, count };
+}
+
+void MappedBinaryReader::adviseSequential() {
+	advise(0, dataSize, MADV_SEQUENTIAL);
+}
+
+void MappedBinaryReader::adviseRandom() {
+	advise(0, dataSize, MADV_RANDOM);
+}
+
+void MappedBinaryReader::adviseWillNeed(uint64_t offset, size_t length) {
+	advise(offset, length, MADV_WILLNEED);
+}
+
+void MappedBinaryReader::adviseDontNeed(uint64_t offset, size_t length) {
+	advise(offset, length, MADV_DONTNEED);
+}
+
+const byte* MappedBinaryReader::take(size_t count) {
+	if (hasError()) {
+		return NULL;
+	}
+	if (count > dataSize - position) {
+		lastError = NotEnoughData;
+		return NULL;
+	}
+
+	const byte* bytes = data + position;
+	position += count;
+	return bytes;
+}
+
+void MappedBinaryReader::readArrayN(void* values, int count, int size) {
+	if (count <= 0) {
+		return;
+	}
+
+	const byte* bytes = take((size_t)count * size);
+	if (bytes == NULL) {
+		return;
+	}
+
+	if ((size == 1) || (isLittleEndian() == (endian == Little))) {
+		memcpy(values, bytes, (size_t)count * size);
+		return;
+	}
+
+	switch (size) {
+		case 2:
+			swapCopy2(values, bytes, count);
+			break;
+		case 4:
+			swapCopy4(values, bytes, count);
+			break;
+		case 8:
+			swapCopy8(values, bytes, count);
+			break;
+	}
+}
+
+void MappedBinaryReader::advise(uint64_t offset, size_t length, int advice) {
+	if ((data == NULL) || (offset >= dataSize)) {
+		return;
+	}
+
+	// madvise needs a page aligned start; round the range out to whole pages
+	uint64_t end = std::min<uint64_t>(offset + length, dataSize);
+	uint64_t start = offset - (offset % pageSize);
+	madvise((void*)(data + start), end - start, advice);
+}
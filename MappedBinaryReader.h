@@ -0,0 +1,77 @@
+#ifndef __MAPPEDBINARYREADER_H__
+#define __MAPPEDBINARYREADER_H__
+
+#include "BinaryIO.h"
+
+// Reader backed by a read-only memory mapping of the whole file. It offers
+// the same read API as BinaryReader, but values are decoded straight from
+// the mapping with no intermediate buffer, and byte ranges can be handed
+// out as views without copying.
+class MappedBinaryReader {
+	public:
+		MappedBinaryReader(const char* fileLocation);
+		MappedBinaryReader(string fileLocation);
+		~MappedBinaryReader();
+		// owns the mapping and the descriptor
+		MappedBinaryReader(const MappedBinaryReader&) = delete;
+		MappedBinaryReader& operator=(const MappedBinaryReader&) = delete;
+		bool hasError();
+		BinaryIOError getError();
+		void forceSetEndian(Endian endian);
+		void forceUnsetEndian();
+		bool moreData();
+		uint64_t getSize();
+		uint64_t getPosition();
+		bool readBool();
+		byte readByte();
+		char readChar();
+		signed char readSChar();
+		unsigned char readUChar();
+		float readFloat();
+		double readDouble();
+		int8_t readInt8();
+		int16_t readInt16();
+		int32_t readInt32();
+		int64_t readInt64();
+		uint8_t readUInt8();
+		uint16_t readUInt16();
+		uint32_t readUInt32();
+		uint64_t readUInt64();
+		vector<byte> readBytes(int count);
+		void readArray(float* values, int count);
+		void readArray(double* values, int count);
+		void readArray(int8_t* values, int count);
+		void readArray(int16_t* values, int count);
+		void readArray(int32_t* values, int count);
+		void readArray(int64_t* values, int count);
+		void readArray(uint8_t* values, int count);
+		void readArray(uint16_t* values, int count);
+		void readArray(uint32_t* values, int count);
+		void readArray(uint64_t* values, int count);
+		// zero copy access; views stay valid for the lifetime of the reader
+		ByteView readView(size_t count);
+		ByteView view(uint64_t offset, size_t count);
+		// access pattern hints, rounded out to whole pages
+		void adviseSequential();
+		void adviseRandom();
+		void adviseWillNeed(uint64_t offset, size_t length);
+		void adviseDontNeed(uint64_t offset, size_t length);
+
+	private:
+		bool isLittleEndian();
+		Endian fileEndian();
+		const byte* take(size_t count);
+		void readArrayN(void* values, int count, int size);
+		void advise(uint64_t offset, size_t length, int advice);
+		void open();
+		string fileLocation;
+		int fd;
+		const byte* data;
+		uint64_t dataSize, position;
+		size_t pageSize;
+		BinaryIOError lastError;
+		bool forceEndian;
+		Endian endianOverride;
+};
+
+#endif // __MAPPEDBINARYREADER_H__
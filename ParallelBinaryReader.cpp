@@ -0,0 +1,202 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ParallelBinaryReader.h"
+
+RangeStream::RangeStream(int fd, uint64_t begin, uint64_t end) {
+	this->fd = fd;
+	this->begin = begin;
+	this->end = std::max(begin, end);
+	position = 0;
+}
+
+BinaryIOError RangeStream::open(const string&, ios::openmode mode) {
+	// the descriptor is already open; only reading is supported
+	if ((fd < 0) || (mode & ios::out)) {
+		return CannotOpenFile;
+	}
+
+	return None;
+}
+
+void RangeStream::close() {
+	fd = -1;
+}
+
+bool RangeStream::isOpen() {
+	return (fd >= 0);
+}
+
+int64_t RangeStream::read(char* dst, size_t count) {
+	int64_t ret = readAt(dst, count, position);
+	if (ret > 0) {
+		position += ret;
+	}
+
+	return ret;
+}
+
+int64_t RangeStream::write(const char*, size_t) {
+	return -1;
+}
+
+int64_t RangeStream::readAt(char* dst, size_t count, uint64_t offset) {
+	if (offset >= end - begin) {
+		return 0;
+	}
+	count = (size_t)std::min((uint64_t)count, end - begin - offset);
+
+	ssize_t ret;
+	do {
+		ret = ::pread(fd, dst, count, begin + offset);
+	} while ((ret < 0) && (errno == EINTR));
+
+	return ret;
+}
+
+int64_t RangeStream::writeAt(const char*, size_t, uint64_t) {
+	return -1;
+}
+
+bool RangeStream::seek(uint64_t offset) {
+	position = offset;
+	return true;
+}
+
+int64_t RangeStream::tell() {
+	return position;
+}
+
+int64_t RangeStream::size() {
+	return end - begin;
+}
+
+bool RangeStream::advise(BinaryIOAdvice advice, uint64_t, uint64_t) {
+	// only sequential read-ahead makes sense per range; it is scoped to the
+	// range so neighbouring workers do not undo each other's hints
+	if (advice != AdviseSequential) {
+		return false;
+	}
+
+	return (posix_fadvise(fd, begin, end - begin, POSIX_FADV_SEQUENTIAL) == 0);
+}
+
+ParallelBinaryReader::ParallelBinaryReader(const char* fileLocation, int threadCount, int bufferSize) {
+	open(string(fileLocation), threadCount, bufferSize);
+}
+
+ParallelBinaryReader::ParallelBinaryReader(string fileLocation, int threadCount, int bufferSize) {
+	open(fileLocation, threadCount, bufferSize);
+}
+
+ParallelBinaryReader::~ParallelBinaryReader() {
+	if (fd >= 0) {
+		::close(fd);
+	}
+}
+
+bool ParallelBinaryReader::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError ParallelBinaryReader::getError() {
+	return lastError;
+}
+
+void ParallelBinaryReader::forceSetEndian(Endian newEndian) {
+	forceEndian = true;
+	endianOverride = newEndian;
+}
+
+void ParallelBinaryReader::forceUnsetEndian() {
+	forceEndian = false;
+}
+
+uint64_t ParallelBinaryReader::getSize() {
+	return fileSize;
+}
+
+int ParallelBinaryReader::getThreadCount() {
+	return threadCount;
+}
+
+vector<BinaryRange> ParallelBinaryReader::partition(int recordSize, int rangeCount) {
+	vector<BinaryRange> ranges;
+	if (hasError() || (recordSize <= 0) || (fileSize == 0)) {
+		return ranges;
+	}
+	if (rangeCount <= 0) {
+		rangeCount = threadCount;
+	}
+
+	uint64_t records = fileSize / recordSize;
+	uint64_t perRange = records / rangeCount;
+	uint64_t extra = records % rangeCount;
+	uint64_t offset = 0;
+	for (int i = 0; i < rangeCount; i++) {
+		uint64_t count = perRange + (((uint64_t)i < extra) ? 1 : 0);
+		if (count == 0) {
+			continue;
+		}
+		ranges.push_back(BinaryRange { offset, offset + count * recordSize });
+		offset += count * recordSize;
+	}
+
+	if (ranges.empty()) {
+		ranges.push_back(BinaryRange { 0, fileSize });
+	} else {
+		ranges.back().end = fileSize;
+	}
+
+	return ranges;
+}
+
+vector<BinaryRange> ParallelBinaryReader::partition(vector<uint64_t> boundaries) {
+	vector<BinaryRange> ranges;
+	if (hasError()) {
+		return ranges;
+	}
+
+	boundaries.push_back(0);
+	boundaries.push_back(fileSize);
+	std::sort(boundaries.begin(), boundaries.end());
+	boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+	for (size_t i = 1; (i < boundaries.size()) && (boundaries[i] <= fileSize); i++) {
+		ranges.push_back(BinaryRange { boundaries[i - 1], boundaries[i] });
+	}
+
+	return ranges;
+}
+
+BinaryReader* ParallelBinaryReader::createReader(const BinaryRange& range) {
+	BinaryReader* reader = new BinaryReader(new RangeStream(fd, range.begin, range.end), "", bufferSize);
+	if (forceEndian) {
+		reader->forceSetEndian(endianOverride);
+	}
+
+	return reader;
+}
+
+void ParallelBinaryReader::open(const string& fileLocation, int threadCount, int bufferSize) {
+	this->threadCount = (threadCount > 0) ? threadCount : std::max((int)std::thread::hardware_concurrency(), 1);
+	this->bufferSize = bufferSize;
+	forceEndian = false;
+	endianOverride = endian;
+	fileSize = 0;
+	lastError = None;
+
+	fd = ::open(fileLocation.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		lastError = (errno == ENOENT) ? FileDoesNotExist : CannotOpenFile;
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		lastError = GenericReadError;
+		return;
+	}
+	fileSize = info.st_size;
+}
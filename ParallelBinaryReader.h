@@ -0,0 +1,127 @@
+#ifndef __PARALLELBINARYREADER_H__
+#define __PARALLELBINARYREADER_H__
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "BinaryIOStream.h"
+
+struct BinaryRange {
+	uint64_t begin;
+	uint64_t end;
+};
+
+// Read-only window [begin, end) over a descriptor it does not own. All
+// transfers are positional, so any number of them can share one file
+// descriptor across threads. Offsets are relative to the start of the range.
+class RangeStream : public BinaryIOStream {
+	public:
+		RangeStream(int fd, uint64_t begin, uint64_t end);
+		// carries a read position; every reader needs its own
+		RangeStream(const RangeStream&) = delete;
+		RangeStream& operator=(const RangeStream&) = delete;
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		bool advise(BinaryIOAdvice advice, uint64_t offset = 0, uint64_t length = 0);
+
+	private:
+		int fd;
+		uint64_t begin, end, position;
+};
+
+// Splits one file into byte ranges and decodes them on a pool of threads.
+// Every range gets its own BinaryReader over a RangeStream, so workers share
+// nothing but the descriptor, and results come back in range order.
+class ParallelBinaryReader {
+	public:
+		// threadCount 0 uses every hardware thread
+		ParallelBinaryReader(const char* fileLocation, int threadCount = 0, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		ParallelBinaryReader(string fileLocation, int threadCount = 0, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		~ParallelBinaryReader();
+		// owns the descriptor shared by every range reader
+		ParallelBinaryReader(const ParallelBinaryReader&) = delete;
+		ParallelBinaryReader& operator=(const ParallelBinaryReader&) = delete;
+		bool hasError();
+		BinaryIOError getError();
+		void forceSetEndian(Endian endian);
+		void forceUnsetEndian();
+		uint64_t getSize();
+		int getThreadCount();
+		// at most rangeCount ranges (0 means one per thread) that start on a
+		// multiple of recordSize; any trailing partial record goes to the last
+		vector<BinaryRange> partition(int recordSize, int rangeCount = 0);
+		// ranges between caller supplied offsets, e.g. from an index
+		vector<BinaryRange> partition(vector<uint64_t> boundaries);
+		// reader over one range; offsets it reports are relative to
+		// range.begin and the caller owns it
+		BinaryReader* createReader(const BinaryRange& range);
+		// calls worker(reader, range, index) for every range and returns the
+		// results indexed like ranges
+		template <typename T, typename F>
+		vector<T> map(const vector<BinaryRange>& ranges, F worker);
+		// map() followed by an in order fold with merge(accumulated, result)
+		template <typename T, typename F, typename M>
+		T mapReduce(const vector<BinaryRange>& ranges, F worker, T initial, M merge);
+
+	private:
+		void open(const string& fileLocation, int threadCount, int bufferSize);
+		int fd;
+		uint64_t fileSize;
+		int threadCount, bufferSize;
+		bool forceEndian;
+		Endian endianOverride;
+		BinaryIOError lastError;
+};
+
+template <typename T, typename F>
+vector<T> ParallelBinaryReader::map(const vector<BinaryRange>& ranges, F worker) {
+	vector<T> results(ranges.size());
+	if (hasError() || ranges.empty()) {
+		return results;
+	}
+
+	// ranges are claimed one at a time, so uneven ranges still balance
+	std::atomic<size_t> next(0);
+	auto run = [&]() {
+		size_t index;
+		while ((index = next.fetch_add(1)) < ranges.size()) {
+			BinaryReader* reader = createReader(ranges[index]);
+			results[index] = worker(*reader, ranges[index], index);
+			delete reader;
+		}
+	};
+
+	int workers = (int)std::min(ranges.size(), (size_t)threadCount);
+	vector<std::thread> threads;
+	for (int i = 1; i < workers; i++) {
+		threads.push_back(std::thread(run));
+	}
+	run();
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+
+	return results;
+}
+
+template <typename T, typename F, typename M>
+T ParallelBinaryReader::mapReduce(const vector<BinaryRange>& ranges, F worker, T initial, M merge) {
+	vector<T> results = map<T>(ranges, worker);
+	for (size_t i = 0; i < results.size(); i++) {
+		initial = merge(initial, results[i]);
+	}
+
+	return initial;
+}
+
+#endif // __PARALLELBINARYREADER_H__
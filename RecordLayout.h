@@ -0,0 +1,261 @@
+#ifndef __RECORDLAYOUT_H__
+#define __RECORDLAYOUT_H__
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+#include "BinaryIO.h"
+#include "ByteOrder.h"
+
+// Compile time wire layout of a plain struct. Specialise RecordLayout with a
+// tuple of member pointers, usually through BINARYIO_RECORD at global scope:
+//
+//     struct Sample { uint32_t id; double value; float axis[3]; };
+//     BINARYIO_RECORD(Sample, &Sample::id, &Sample::value, &Sample::axis)
+//
+// Fields go on the wire in the listed order with no padding, each in the
+// file byte order. Fields may be arithmetic types, enums, or fixed size
+// arrays of them.
+template <typename T>
+struct RecordLayout;
+
+#define BINARYIO_RECORD(Type, ...) \
+	template <> \
+	struct RecordLayout<Type> { \
+		static constexpr auto fields = std::make_tuple(__VA_ARGS__); \
+	};
+
+template <typename C, typename M>
+constexpr size_t recordFieldSize(M C::*) {
+	return sizeof(M);
+}
+
+template <typename T>
+constexpr size_t recordWireSize() {
+	return std::apply([](auto... fields) {
+		return (recordFieldSize(fields) + ... + 0);
+	}, RecordLayout<T>::fields);
+}
+
+// True when the wire layout is the in-memory layout: fields listed in
+// declaration order and no padding anywhere. Such records move with one
+// memcpy per batch when no byte swap is needed.
+template <typename T>
+bool recordIsPacked() {
+	static const bool packed = []() {
+		if (recordWireSize<T>() != sizeof(T)) {
+			return false;
+		}
+
+		static const T probe = T();
+		size_t expected = 0;
+		bool inOrder = true;
+		std::apply([&](auto... fields) {
+			((inOrder = inOrder && ((size_t)((const char*)&(probe.*fields) - (const char*)&probe) == expected), expected += recordFieldSize(fields)), ...);
+		}, RecordLayout<T>::fields);
+		return inOrder;
+	}();
+	return packed;
+}
+
+template <bool Swap, typename F>
+inline void decodeRecordField(const byte* in, F& field) {
+	if constexpr (std::is_array<F>::value) {
+		typedef typename std::remove_extent<F>::type Element;
+		for (size_t i = 0; i < std::extent<F>::value; i++) {
+			decodeRecordField<Swap>(in + i * sizeof(Element), field[i]);
+		}
+	} else {
+		static_assert(std::is_arithmetic<F>::value || std::is_enum<F>::value, "record fields must be arithmetic, enums or arrays of them");
+		if constexpr (Swap && (sizeof(F) == 2)) {
+			uint16_t bits;
+			memcpy(&bits, in, 2);
+			bits = byteSwap(bits);
+			memcpy(&field, &bits, 2);
+		} else if constexpr (Swap && (sizeof(F) == 4)) {
+			uint32_t bits;
+			memcpy(&bits, in, 4);
+			bits = byteSwap(bits);
+			memcpy(&field, &bits, 4);
+		} else if constexpr (Swap && (sizeof(F) == 8)) {
+			uint64_t bits;
+			memcpy(&bits, in, 8);
+			bits = byteSwap(bits);
+			memcpy(&field, &bits, 8);
+		} else {
+			memcpy(&field, in, sizeof(F));
+		}
+	}
+}
+
+template <bool Swap, typename F>
+inline void encodeRecordField(byte* out, const F& field) {
+	if constexpr (std::is_array<F>::value) {
+		typedef typename std::remove_extent<F>::type Element;
+		for (size_t i = 0; i < std::extent<F>::value; i++) {
+			encodeRecordField<Swap>(out + i * sizeof(Element), field[i]);
+		}
+	} else {
+		static_assert(std::is_arithmetic<F>::value || std::is_enum<F>::value, "record fields must be arithmetic, enums or arrays of them");
+		if constexpr (Swap && (sizeof(F) == 2)) {
+			uint16_t bits;
+			memcpy(&bits, &field, 2);
+			bits = byteSwap(bits);
+			memcpy(out, &bits, 2);
+		} else if constexpr (Swap && (sizeof(F) == 4)) {
+			uint32_t bits;
+			memcpy(&bits, &field, 4);
+			bits = byteSwap(bits);
+			memcpy(out, &bits, 4);
+		} else if constexpr (Swap && (sizeof(F) == 8)) {
+			uint64_t bits;
+			memcpy(&bits, &field, 8);
+			bits = byteSwap(bits);
+			memcpy(out, &bits, 8);
+		} else {
+			memcpy(out, &field, sizeof(F));
+		}
+	}
+}
+
+// Field offsets are constants after inlining, so a record decodes to one
+// load (and bswap) per field.
+template <bool Swap, typename T>
+inline void decodeRecord(const byte* in, T& record) {
+	std::apply([&](auto... fields) {
+		size_t offset = 0;
+		((decodeRecordField<Swap>(in + offset, record.*fields), offset += recordFieldSize(fields)), ...);
+	}, RecordLayout<T>::fields);
+}
+
+template <bool Swap, typename T>
+inline void encodeRecord(byte* out, const T& record) {
+	std::apply([&](auto... fields) {
+		size_t offset = 0;
+		((encodeRecordField<Swap>(out + offset, record.*fields), offset += recordFieldSize(fields)), ...);
+	}, RecordLayout<T>::fields);
+}
+
+template <typename T>
+void BinaryReader::readRecord(T& record) {
+	readRecords(&record, 1);
+}
+
+template <typename T>
+void BinaryReader::readRecords(T* records, int count) {
+	static_assert(std::is_trivially_copyable<T>::value, "records must be trivially copyable");
+	constexpr size_t size = recordWireSize<T>();
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+	stats.values[RecordValue] += count;
+
+	bool swap = needsByteSwap();
+	if (!swap && recordIsPacked<T>()) {
+		readRaw(records, (size_t)count * size);
+		return;
+	}
+
+	if (size > (size_t)bufferSize) {
+		std::array<byte, size> bytes;
+		for (int i = 0; (i < count) && !hasError(); i++) {
+			if (readRaw(bytes.data(), size) != size) {
+				return;
+			}
+			if (swap) {
+				decodeRecord<true>(bytes.data(), records[i]);
+			} else {
+				decodeRecord<false>(bytes.data(), records[i]);
+			}
+		}
+		return;
+	}
+
+	int done = 0;
+	while (done < count) {
+		if (!ensureBuffered(size)) {
+			if (!hasError()) {
+				lastError = NotEnoughData;
+			}
+			return;
+		}
+
+		// decode every whole record that is already buffered in one go
+		int batch = std::min((int)((bufferDataSize - bufferPos) / size), count - done);
+		const byte* in = (const byte*)buffer + bufferPos;
+		if (swap) {
+			for (int i = 0; i < batch; i++) {
+				decodeRecord<true>(in + i * size, records[done + i]);
+			}
+		} else {
+			for (int i = 0; i < batch; i++) {
+				decodeRecord<false>(in + i * size, records[done + i]);
+			}
+		}
+		bufferPos += batch * size;
+		done += batch;
+	}
+}
+
+template <typename T>
+void BinaryWriter::writeRecord(const T& record) {
+	writeRecords(&record, 1);
+}
+
+template <typename T>
+void BinaryWriter::writeRecords(const T* records, int count) {
+	static_assert(std::is_trivially_copyable<T>::value, "records must be trivially copyable");
+	constexpr size_t size = recordWireSize<T>();
+	if (hasError() || (count <= 0)) {
+		return;
+	}
+	stats.values[RecordValue] += count;
+
+	bool swap = needsByteSwap();
+	if (!swap && recordIsPacked<T>()) {
+		writeRaw(records, (size_t)count * size);
+		return;
+	}
+
+	if (size > (size_t)bufferSize) {
+		std::array<byte, size> bytes;
+		for (int i = 0; (i < count) && !hasError(); i++) {
+			if (swap) {
+				encodeRecord<true>(bytes.data(), records[i]);
+			} else {
+				encodeRecord<false>(bytes.data(), records[i]);
+			}
+			writeRaw(bytes.data(), size);
+		}
+		return;
+	}
+
+	int done = 0;
+	while (done < count) {
+		if ((size_t)(bufferSize - bufferPos) < size) {
+			flush();
+		}
+		if (hasError()) {
+			return;
+		}
+
+		int batch = std::min((int)((bufferSize - bufferPos) / size), count - done);
+		byte* out = (byte*)buffer + bufferPos;
+		if (swap) {
+			for (int i = 0; i < batch; i++) {
+				encodeRecord<true>(out + i * size, records[done + i]);
+			}
+		} else {
+			for (int i = 0; i < batch; i++) {
+				encodeRecord<false>(out + i * size, records[done + i]);
+			}
+		}
+		bufferPos += batch * size;
+		done += batch;
+	}
+}
+
+#endif // __RECORDLAYOUT_H__
@@ -0,0 +1,185 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SharedAppendWriter.h"
+
+AppendStream::AppendStream(int fd, std::atomic<uint64_t>* tail) {
+	this->fd = fd;
+	this->tail = tail;
+	committing = false;
+}
+
+BinaryIOError AppendStream::open(const string&, ios::openmode mode) {
+	// the descriptor is already open; only writing is supported
+	if ((fd < 0) || (mode & ios::in)) {
+		return CannotOpenFile;
+	}
+
+	return None;
+}
+
+void AppendStream::close() {
+	fd = -1;
+}
+
+bool AppendStream::isOpen() {
+	return (fd >= 0);
+}
+
+int64_t AppendStream::read(char*, size_t) {
+	return -1;
+}
+
+int64_t AppendStream::write(const char* src, size_t count) {
+	if (!committing) {
+		// a flush in the middle of a commit unit; hold on to it
+		staged.insert(staged.end(), src, src + count);
+		return count;
+	}
+	if (staged.empty()) {
+		return writeRange(src, count);
+	}
+
+	staged.insert(staged.end(), src, src + count);
+	int64_t ret = writeRange(staged.data(), staged.size());
+	staged.clear();
+	// the staged bytes were reported when they were staged
+	return (ret < 0) ? ret : (int64_t)count;
+}
+
+int64_t AppendStream::readAt(char*, size_t, uint64_t) {
+	return -1;
+}
+
+int64_t AppendStream::writeAt(const char* src, size_t count, uint64_t offset) {
+	size_t written = 0;
+	while (written < count) {
+		ssize_t ret = ::pwrite(fd, src + written, count - written, offset + written);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		written += ret;
+	}
+
+	return written;
+}
+
+bool AppendStream::seek(uint64_t) {
+	return false;
+}
+
+int64_t AppendStream::tell() {
+	return tail->load();
+}
+
+int64_t AppendStream::size() {
+	return tail->load();
+}
+
+void AppendStream::setCommitting(bool committing) {
+	this->committing = committing;
+}
+
+bool AppendStream::hasStaged() {
+	return !staged.empty();
+}
+
+int64_t AppendStream::writeRange(const char* src, size_t count) {
+	if (count == 0) {
+		return 0;
+	}
+
+	// a failed write leaves a zero filled hole the size of its range
+	uint64_t offset = tail->fetch_add(count, std::memory_order_relaxed);
+	return writeAt(src, count, offset);
+}
+
+AppendWriter::AppendWriter(AppendStream* stream, int bufferSize) : BinaryWriter(stream, "", false, bufferSize) {
+	appendStream = stream;
+}
+
+AppendWriter::~AppendWriter() {
+	commit();
+}
+
+void AppendWriter::endRecord() {
+	if (appendStream->hasStaged() || (bufferPos >= bufferSize / 2)) {
+		commit();
+	}
+}
+
+void AppendWriter::commit() {
+	appendStream->setCommitting(true);
+	flush();
+	appendStream->setCommitting(false);
+}
+
+SharedAppendWriter::SharedAppendWriter(const char* fileLocation, bool overwrite, int bufferSize) : tail(0) {
+	open(string(fileLocation), overwrite, bufferSize);
+}
+
+SharedAppendWriter::SharedAppendWriter(string fileLocation, bool overwrite, int bufferSize) : tail(0) {
+	open(fileLocation, overwrite, bufferSize);
+}
+
+SharedAppendWriter::~SharedAppendWriter() {
+	if (fd >= 0) {
+		::close(fd);
+	}
+}
+
+bool SharedAppendWriter::hasError() {
+	return (lastError != None);
+}
+
+BinaryIOError SharedAppendWriter::getError() {
+	return lastError;
+}
+
+void SharedAppendWriter::forceSetEndian(Endian newEndian) {
+	forceEndian = true;
+	endianOverride = newEndian;
+}
+
+void SharedAppendWriter::forceUnsetEndian() {
+	forceEndian = false;
+}
+
+AppendWriter* SharedAppendWriter::createWriter() {
+	AppendWriter* writer = new AppendWriter(new AppendStream(fd, &tail), bufferSize);
+	if (forceEndian) {
+		writer->forceSetEndian(endianOverride);
+	}
+
+	return writer;
+}
+
+uint64_t SharedAppendWriter::getSize() {
+	return tail.load();
+}
+
+void SharedAppendWriter::open(const string& fileLocation, bool overwrite, int bufferSize) {
+	this->bufferSize = bufferSize;
+	forceEndian = false;
+	endianOverride = endian;
+	lastError = None;
+
+	// no O_APPEND: Linux ignores the pwrite offset on such descriptors
+	fd = ::open(fileLocation.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : 0), 0666);
+	if (fd < 0) {
+		lastError = CannotOpenFile;
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		lastError = GenericWriteError;
+		return;
+	}
+	tail = info.st_size;
+}
@@ -0,0 +1,90 @@
+#ifndef __SHAREDAPPENDWRITER_H__
+#define __SHAREDAPPENDWRITER_H__
+
+#include <atomic>
+
+#include "BinaryIOStream.h"
+
+// Write side of an AppendWriter. Bytes flushed before a commit are staged
+// in memory; a commit reserves one range at the end of the file with a
+// single fetch-add on the shared tail and pwrites it, so concurrent
+// writers never take a lock and never interleave inside a range. The
+// descriptor and the tail belong to the SharedAppendWriter.
+class AppendStream : public BinaryIOStream {
+	public:
+		AppendStream(int fd, std::atomic<uint64_t>* tail);
+		BinaryIOError open(const string& fileLocation, ios::openmode mode);
+		void close();
+		bool isOpen();
+		int64_t read(char* dst, size_t count);
+		int64_t write(const char* src, size_t count);
+		int64_t readAt(char* dst, size_t count, uint64_t offset);
+		int64_t writeAt(const char* src, size_t count, uint64_t offset);
+		bool seek(uint64_t offset);
+		int64_t tell();
+		int64_t size();
+		void setCommitting(bool committing);
+		bool hasStaged();
+
+	private:
+		int64_t writeRange(const char* src, size_t count);
+		int fd;
+		std::atomic<uint64_t>* tail;
+		bool committing;
+		vector<char> staged;
+};
+
+// Per thread writer into a SharedAppendWriter. Everything written between
+// two commits lands in the file as one contiguous range, in commit order
+// for this writer but in any order relative to other writers. Not for use
+// with enableAsyncFlush.
+//
+// getStats() sees the staging step, not the file: bytes count once, when
+// they leave the buffer, and every buffer flush counts as one stream call
+// whether it was staged or written out, while a commit of staged bytes
+// alone counts none.
+class AppendWriter : public BinaryWriter {
+	public:
+		AppendWriter(AppendStream* stream, int bufferSize = DEFAULT_BUFFERSIZE);
+		// commits whatever is still pending
+		~AppendWriter();
+		// marks a record boundary; commits once half a buffer is pending, or
+		// straight away if a record outgrew the buffer
+		void endRecord();
+		// hands everything written since the last commit to the file
+		void commit();
+
+	private:
+		AppendStream* appendStream;
+};
+
+// One output file shared by any number of threads, each with its own
+// AppendWriter. Only appends through this object are accounted for, so
+// nothing else may write to the file while it is open.
+class SharedAppendWriter {
+	public:
+		SharedAppendWriter(const char* fileLocation, bool overwrite = false, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		SharedAppendWriter(string fileLocation, bool overwrite = false, int bufferSize = BinaryIOBase::DEFAULT_BUFFERSIZE);
+		// every writer must be destroyed first
+		~SharedAppendWriter();
+		bool hasError();
+		BinaryIOError getError();
+		// applied to writers created afterwards
+		void forceSetEndian(Endian endian);
+		void forceUnsetEndian();
+		// the caller owns the writer
+		AppendWriter* createWriter();
+		// bytes reserved so far, including ranges still being written
+		uint64_t getSize();
+
+	private:
+		void open(const string& fileLocation, bool overwrite, int bufferSize);
+		int fd;
+		std::atomic<uint64_t> tail;
+		int bufferSize;
+		bool forceEndian;
+		Endian endianOverride;
+		BinaryIOError lastError;
+};
+
+#endif // __SHAREDAPPENDWRITER_H__
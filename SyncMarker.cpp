@@ -0,0 +1,193 @@
+#include <cstring>
+#include <random>
+
+#include "SyncMarker.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SYNCMARKER_X86 1
+#include <immintrin.h>
+#endif
+
+static const char SYNCMARKER_MAGIC[4] = { 'B', 'S', 'Y', 'N' };
+static const uint8_t SYNCMARKER_VERSION = 1;
+// the header's copy of the marker follows the magic and the version
+static const uint64_t SYNCMARKER_HEADERSYNC = 5;
+
+#ifdef SYNCMARKER_X86
+static bool hasAVX2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+// Looks at 32 candidate offsets per step: only those where both the first
+// and the last marker byte match get a full compare. Returns true with the
+// offset of a match, or false with the offset the scalar search has to
+// continue from.
+__attribute__((target("avx2")))
+static bool findSyncMarkerAVX2(const byte* data, size_t size, const byte* marker, size_t& offset) {
+	const __m256i first = _mm256_set1_epi8((char)marker[0]);
+	const __m256i last = _mm256_set1_epi8((char)marker[SYNCMARKER_SIZE - 1]);
+	size_t i = 0;
+
+	for (; i + SYNCMARKER_SIZE - 1 + 32 <= size; i += 32) {
+		__m256i head = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i tail = _mm256_loadu_si256((const __m256i*)(data + i + SYNCMARKER_SIZE - 1));
+		uint32_t candidates = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last)));
+		while (candidates != 0) {
+			size_t candidate = i + __builtin_ctz(candidates);
+			if (memcmp(data + candidate + 1, marker + 1, SYNCMARKER_SIZE - 2) == 0) {
+				offset = candidate;
+				return true;
+			}
+			candidates &= candidates - 1;
+		}
+	}
+
+	offset = i;
+	return false;
+}
+#endif
+
+size_t findSyncMarker(const byte* data, size_t size, const byte* marker) {
+	if (size < (size_t)SYNCMARKER_SIZE) {
+		return size;
+	}
+
+	size_t i = 0;
+#ifdef SYNCMARKER_X86
+	static const bool simd = hasAVX2();
+	if (simd && findSyncMarkerAVX2(data, size, marker, i)) {
+		return i;
+	}
+#endif
+
+	// memchr is vectorized by libc, so this stays fast on other targets
+	size_t last = size - SYNCMARKER_SIZE;
+	while (i <= last) {
+		const byte* candidate = (const byte*)memchr(data + i, marker[0], last - i + 1);
+		if (candidate == NULL) {
+			break;
+		}
+		i = candidate - data;
+		if (memcmp(candidate, marker, SYNCMARKER_SIZE) == 0) {
+			return i;
+		}
+		i++;
+	}
+
+	return size;
+}
+
+SyncMarkerWriter::SyncMarkerWriter(const char* fileLocation, int syncInterval, int recordInterval, int bufferSize) : SyncMarkerWriter(string(fileLocation), syncInterval, recordInterval, bufferSize) {
+
+}
+
+SyncMarkerWriter::SyncMarkerWriter(string fileLocation, int syncInterval, int recordInterval, int bufferSize) : BinaryWriter(fileLocation, true, bufferSize) {
+	this->syncInterval = (syncInterval > 0) ? syncInterval : 0;
+	this->recordInterval = (recordInterval > 0) ? recordInterval : 0;
+	records = 0;
+
+	std::random_device random;
+	for (int i = 0; i < SYNCMARKER_SIZE; i += 4) {
+		uint32_t value = random();
+		memcpy(marker + i, &value, 4);
+	}
+	writeHeader();
+}
+
+void SyncMarkerWriter::endRecord() {
+	records++;
+	if (((syncInterval > 0) && (tell() - lastSync >= syncInterval)) || ((recordInterval > 0) && (records >= recordInterval))) {
+		writeSyncMarker();
+	}
+}
+
+void SyncMarkerWriter::writeSyncMarker() {
+	lastSync = tell();
+	records = 0;
+	writeArray((const uint8_t*)marker, SYNCMARKER_SIZE);
+}
+
+const byte* SyncMarkerWriter::getSyncMarker() {
+	return marker;
+}
+
+void SyncMarkerWriter::writeHeader() {
+	writeArray((const uint8_t*)SYNCMARKER_MAGIC, 4);
+	writeArray(&SYNCMARKER_VERSION, 1);
+	writeSyncMarker();
+}
+
+SyncMarkerReader::SyncMarkerReader(const char* fileLocation, int bufferSize) : SyncMarkerReader(string(fileLocation), bufferSize) {
+
+}
+
+SyncMarkerReader::SyncMarkerReader(string fileLocation, int bufferSize) : BinaryReader(fileLocation, bufferSize) {
+	memset(marker, 0, SYNCMARKER_SIZE);
+	lastSync = SYNCMARKER_HEADERSYNC;
+	if (!hasError()) {
+		readHeader();
+	}
+}
+
+bool SyncMarkerReader::seekToSync(uint64_t offset) {
+	if (!seek(offset)) {
+		return false;
+	}
+
+	while (true) {
+		if (!ensureBuffered(SYNCMARKER_SIZE)) {
+			// less than a marker left; park at the end of the file
+			bufferPos = bufferDataSize;
+			lastSync = tell();
+			return false;
+		}
+
+		size_t available = bufferDataSize - bufferPos;
+		size_t found = findSyncMarker((const byte*)buffer + bufferPos, available, marker);
+		if (found < available) {
+			bufferPos += found;
+			lastSync = tell();
+			bufferPos += SYNCMARKER_SIZE;
+			return true;
+		}
+		// keep the bytes a marker straddling the refill could start in
+		bufferPos = bufferDataSize - (SYNCMARKER_SIZE - 1);
+	}
+}
+
+bool SyncMarkerReader::nextRecord() {
+	if (hasError() || !moreData()) {
+		return false;
+	}
+
+	if (ensureBuffered(SYNCMARKER_SIZE) && (memcmp(buffer + bufferPos, marker, SYNCMARKER_SIZE) == 0)) {
+		lastSync = tell();
+		bufferPos += SYNCMARKER_SIZE;
+		return moreData();
+	}
+
+	return !hasError();
+}
+
+uint64_t SyncMarkerReader::getLastSync() {
+	return lastSync;
+}
+
+const byte* SyncMarkerReader::getSyncMarker() {
+	return marker;
+}
+
+void SyncMarkerReader::readHeader() {
+	for (int i = 0; i < 4; i++) {
+		if (readChar() != SYNCMARKER_MAGIC[i]) {
+			lastError = hasError() ? lastError : InvalidData;
+			return;
+		}
+	}
+	if (readUInt8() != SYNCMARKER_VERSION) {
+		lastError = hasError() ? lastError : InvalidData;
+		return;
+	}
+	readInto(marker, SYNCMARKER_SIZE);
+}
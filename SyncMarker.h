@@ -0,0 +1,71 @@
+#ifndef __SYNCMARKER_H__
+#define __SYNCMARKER_H__
+
+#include "BinaryIO.h"
+
+// Framing for files of variable length records that lets a reader start at
+// any byte offset:
+//
+//     header: "BSYN", uint8 version, 16 byte sync marker
+//     body:   records, with the marker repeated after a record whenever
+//             syncInterval bytes or recordInterval records have gone by
+//
+// The marker is random per file, so it turning up inside a record is
+// astronomically unlikely and is not escaped. Every marker starts a block
+// of whole records; the copy in the header opens the first one.
+//
+// To split a file over workers, give each a byte range [begin, end) and
+// let it decode the blocks whose marker starts in that range:
+//
+//     SyncMarkerReader reader(file);
+//     reader.seekToSync(begin);
+//     while (reader.nextRecord() && (reader.getLastSync() < end)) {
+//         ...decode one record...
+//     }
+
+static const int SYNCMARKER_SIZE = 16;
+
+// offset of the first copy of marker in data, or size if there is none;
+// vectorized where the CPU allows
+size_t findSyncMarker(const byte* data, size_t size, const byte* marker);
+
+class SyncMarkerWriter : public BinaryWriter {
+	public:
+		static const int DEFAULT_SYNCINTERVAL = 65536;
+		// the file is always overwritten; an interval of 0 turns that trigger off
+		SyncMarkerWriter(const char* fileLocation, int syncInterval = DEFAULT_SYNCINTERVAL, int recordInterval = 0, int bufferSize = DEFAULT_BUFFERSIZE);
+		SyncMarkerWriter(string fileLocation, int syncInterval = DEFAULT_SYNCINTERVAL, int recordInterval = 0, int bufferSize = DEFAULT_BUFFERSIZE);
+		// call after every record; writes a marker once an interval is up
+		void endRecord();
+		// writes a marker now; must sit between records
+		void writeSyncMarker();
+		const byte* getSyncMarker();
+
+	private:
+		void writeHeader();
+		byte marker[SYNCMARKER_SIZE];
+		uint64_t syncInterval, lastSync;
+		int recordInterval, records;
+};
+
+class SyncMarkerReader : public BinaryReader {
+	public:
+		SyncMarkerReader(const char* fileLocation, int bufferSize = DEFAULT_BUFFERSIZE);
+		SyncMarkerReader(string fileLocation, int bufferSize = DEFAULT_BUFFERSIZE);
+		// moves to the first block whose marker starts at or after offset;
+		// false when there is none
+		bool seekToSync(uint64_t offset);
+		// call before every record; steps over a marker in front of it and
+		// returns false at the end of the file
+		bool nextRecord();
+		// file offset of the marker that opened the current block
+		uint64_t getLastSync();
+		const byte* getSyncMarker();
+
+	private:
+		void readHeader();
+		byte marker[SYNCMARKER_SIZE];
+		uint64_t lastSync;
+};
+
+#endif // __SYNCMARKER_H__
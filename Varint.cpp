@@ -0,0 +1,132 @@
+#include <cstring>
+
+#include "Varint.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define VARINT_X86 1
+#include <immintrin.h>
+#endif
+
+struct StreamVByteTables {
+	uint8_t length[256];
+	uint8_t shuffle[256][16];
+};
+
+static StreamVByteTables buildTables() {
+	StreamVByteTables tables;
+	for (int control = 0; control < 256; control++) {
+		int position = 0;
+		for (int value = 0; value < 4; value++) {
+			int size = ((control >> (2 * value)) & 3) + 1;
+			for (int i = 0; i < 4; i++) {
+				// 0xFF makes pshufb write a zero byte
+				tables.shuffle[control][4 * value + i] = (i < size) ? position++ : 0xFF;
+			}
+		}
+		tables.length[control] = position;
+	}
+	return tables;
+}
+
+static const StreamVByteTables& streamVByteTables() {
+	static const StreamVByteTables tables = buildTables();
+	return tables;
+}
+
+static inline int valueSize(uint32_t value) {
+	if (value < (1U << 8)) {
+		return 1;
+	}
+	if (value < (1U << 16)) {
+		return 2;
+	}
+	if (value < (1U << 24)) {
+		return 3;
+	}
+	return 4;
+}
+
+size_t streamVByteEncode(const uint32_t* values, size_t count, uint8_t* control, uint8_t* data) {
+	uint8_t* out = data;
+	memset(control, 0, streamVByteControlSize(count));
+
+	for (size_t i = 0; i < count; i++) {
+		uint32_t value = values[i];
+		int size = valueSize(value);
+		control[i / 4] |= (uint8_t)((size - 1) << (2 * (i % 4)));
+		for (int j = 0; j < size; j++) {
+			*out++ = (uint8_t)(value >> (8 * j));
+		}
+	}
+
+	return out - data;
+}
+
+size_t streamVByteDataSize(const uint8_t* control, size_t count) {
+	const StreamVByteTables& tables = streamVByteTables();
+	size_t size = 0;
+	size_t groups = count / 4;
+	for (size_t i = 0; i < groups; i++) {
+		size += tables.length[control[i]];
+	}
+	for (size_t i = groups * 4; i < count; i++) {
+		size += ((control[groups] >> (2 * (i % 4))) & 3) + 1;
+	}
+
+	return size;
+}
+
+#ifdef VARINT_X86
+static bool hasSSSE3() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
+}
+
+// Decodes whole groups while 16 bytes can be loaded; returns the number of
+// groups done and advances data past them.
+__attribute__((target("ssse3")))
+static size_t decodeGroupsSSSE3(const uint8_t* control, size_t groups, const uint8_t*& data, const uint8_t* dataEnd, uint32_t* values) {
+	const StreamVByteTables& tables = streamVByteTables();
+	const uint8_t* in = data;
+	size_t i = 0;
+
+	for (; (i < groups) && (in + 16 <= dataEnd); i++) {
+		uint8_t key = control[i];
+		__m128i bytes = _mm_loadu_si128((const __m128i*)in);
+		__m128i shuffle = _mm_loadu_si128((const __m128i*)tables.shuffle[key]);
+		_mm_storeu_si128((__m128i*)(values + 4 * i), _mm_shuffle_epi8(bytes, shuffle));
+		in += tables.length[key];
+	}
+
+	data = in;
+	return i;
+}
+#endif
+
+size_t streamVByteDecode(const uint8_t* control, const uint8_t* data, size_t available, size_t count, uint32_t* values) {
+	size_t size = streamVByteDataSize(control, count);
+	if (size > available) {
+		return 0;
+	}
+
+	const uint8_t* in = data;
+	size_t i = 0;
+#ifdef VARINT_X86
+	static const bool simd = hasSSSE3();
+	if (simd) {
+		i = 4 * decodeGroupsSSSE3(control, count / 4, in, data + available, values);
+	}
+#endif
+
+	for (; i < count; i++) {
+		int length = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+		uint32_t value = 0;
+		for (int j = 0; j < length; j++) {
+			value |= (uint32_t)in[j] << (8 * j);
+		}
+		values[i] = value;
+		in += length;
+	}
+
+	return size;
+}
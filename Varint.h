@@ -0,0 +1,77 @@
+#ifndef __VARINT_H__
+#define __VARINT_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// LEB128: seven bits per byte, least significant group first, high bit set
+// on every byte but the last. A 64 bit value takes at most 10 bytes.
+static const int VARINT_MAXSIZE = 10;
+
+static inline int encodeVarint(uint64_t value, uint8_t* out) {
+	int size = 0;
+	while (value >= 0x80) {
+		out[size++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[size++] = (uint8_t)value;
+	return size;
+}
+
+// Returns the number of bytes consumed, or 0 when the input ends inside the
+// value or the value runs past VARINT_MAXSIZE bytes.
+static inline int decodeVarint(const uint8_t* in, size_t available, uint64_t& value) {
+	uint64_t result = 0;
+	size_t limit = (available < (size_t)VARINT_MAXSIZE) ? available : VARINT_MAXSIZE;
+	for (size_t i = 0; i < limit; i++) {
+		result |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+		if ((in[i] & 0x80) == 0) {
+			value = result;
+			return (int)(i + 1);
+		}
+	}
+	return 0;
+}
+
+// Zigzag maps signed values of small magnitude to small unsigned ones:
+// 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+static inline uint64_t zigzagEncode(int64_t value) {
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t zigzagDecode(uint64_t value) {
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline uint32_t zigzagEncode32(int32_t value) {
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t zigzagDecode32(uint32_t value) {
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Stream VByte bulk layout for 32 bit values. Lengths are kept apart from
+// the payload: one control byte per group of four values, two bits each
+// (length - 1, first value in the low bits), followed by the little endian
+// value bytes with leading zero bytes dropped. Keeping the lengths apart is
+// what lets a whole group be decoded with a single shuffle.
+static inline size_t streamVByteControlSize(size_t count) {
+	return (count + 3) / 4;
+}
+
+static inline size_t streamVByteMaxDataSize(size_t count) {
+	return count * 4;
+}
+
+// Writes the control bytes to control and the payload to data; returns the
+// payload size.
+size_t streamVByteEncode(const uint32_t* values, size_t count, uint8_t* control, uint8_t* data);
+// Payload size described by count values worth of control bytes.
+size_t streamVByteDataSize(const uint8_t* control, size_t count);
+// Decodes count values; available bytes must be readable from data, and may
+// exceed the payload, which lets the SIMD kernel run closer to the end.
+// Returns the payload size consumed, or 0 when available is too small.
+size_t streamVByteDecode(const uint8_t* control, const uint8_t* data, size_t available, size_t count, uint32_t* values);
+
+#endif // __VARINT_H__